@@ -15,9 +15,16 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/math_extras.h>
 #include <zephyr/sys/util.h>
 
 #include "buttonMngr.h"
+#include "debounce.h"
+#include "gpioPort.h"
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+#include "encoderQdec.h"
+#endif
 #include "zephyrCommon.h"
 #include "zephyrGpio.h"
 #include "zephyrThread.h"
@@ -28,15 +35,65 @@
 LOG_MODULE_REGISTER(BUTTON_MNGR_MODULE_NAME);
 
 /**
- * @brief The thread stack size.
+ * @brief The thread stack size. The scan, settle calibration and idle paths
+ *        peak at 344 bytes, the rest covers the kernel calls, the deferred
+ *        logging and the exception frame.
 */
-#define BUTTON_MNGR_STACK_SIZE      256
+#define BUTTON_MNGR_STACK_SIZE      1024
 
 /**
  * @brief The thread name.
  */
 #define BUTTON_MNGR_THREAD_NAME     "buttonMngr"
 
+/**
+ * @brief The scan period [us].
+*/
+#define BUTTON_MNGR_SCAN_PERIOD_US  (USEC_PER_SEC / CONFIG_BUTTON_MNGR_SCAN_RATE_HZ)
+
+/**
+ * @brief The button matrix key count.
+*/
+#define BUTTON_MNGR_MATRIX_KEY_CNT  (BUTTON_ROW_COUNT * BUTTON_COL_COUNT)
+
+/**
+ * @brief The row mask of a column in the raw matrix word.
+*/
+#define BUTTON_MNGR_COL_ROW_MASK    BIT_MASK(BUTTON_ROW_COUNT)
+
+/**
+ * @brief The maximal column settle time [cycles].
+*/
+#define BUTTON_MNGR_SETTLE_MAX_CYCLES                                        \
+  k_ns_to_cyc_ceil32(CONFIG_BUTTON_MNGR_SETTLE_MAX_NS)
+
+/**
+ * @brief The column settle time calibration step [cycles].
+*/
+#define BUTTON_MNGR_SETTLE_STEP_CYCLES                                       \
+  MAX(k_ns_to_cyc_ceil32(CONFIG_BUTTON_MNGR_SETTLE_STEP_NS), 1)
+
+/**
+ * @brief The settle time calibration timeout.
+*/
+#define BUTTON_MNGR_SETTLE_CALIB_TIMEOUT  K_SECONDS(1)
+
+/**
+ * @brief Convert a debounce time to a scan sample count.
+*/
+#define BUTTON_MNGR_DEBOUNCE_SAMPLES(timeMs)                                 \
+  MAX(1, (timeMs) * CONFIG_BUTTON_MNGR_SCAN_RATE_HZ / MSEC_PER_SEC)
+
+/**
+ * @brief The shifter button mask in the input button word.
+*/
+#define BUTTON_MNGR_SHIFTER_MASK    (BIT_MASK(BUTTON_SHIFTER_COUNT) << LEFT_SHIFTER_IDX)
+
+/**
+ * @brief The rocker button mask in the input button word.
+*/
+#define BUTTON_MNGR_ROCKER_MASK     (BIT_MASK(BUTTON_ROCKER_COUNT) << LEFT_ROCKER_IDX)
+
 /**
  * @brief The encoder signal count.
 */
@@ -48,18 +105,31 @@ LOG_MODULE_REGISTER(BUTTON_MNGR_MODULE_NAME);
 #define BUTTON_MNGR_ENC_COUNT       6
 
 /**
- * @brief The encoder indexes
+ * @brief The polled encoder sampling period [us].
 */
-enum
-{
-  LEFT_ENC_IDX = 0,                         /**< The left encoder index. */
-  RIGHT_ENC_IDX,                            /**< The right encoder index. */
-  TC_ENC_IDX,                               /**< The TC encoder index. */
-  TC1_ENC_IDX,                              /**< The TC1 encoder index. */
-  ABS_ENC_IDX,                              /**< The ABS encoder index. */
-  MAP_ENC_IDX,                              /**< The MAP encoder index. */
-  ENCODER_COUNT,                            /**< The total encoder count. */
-};
+#define BUTTON_MNGR_ENC_POLL_PERIOD_US  (USEC_PER_SEC /                      \
+                                         CONFIG_BUTTON_MNGR_ENC_POLL_RATE_HZ)
+
+/**
+ * @brief The maximal polled encoder port count, one per signal.
+*/
+#define BUTTON_MNGR_ENC_POLL_PORT_MAX   (BUTTON_MNGR_ENC_COUNT *              \
+                                         BUTTON_MNGR_ENC_SIG_CNT)
+
+/**
+ * @brief The encoder rest state (A << 1 | B).
+*/
+#ifdef CONFIG_BUTTON_MNGR_ENC_REST_RESYNC
+#define BUTTON_MNGR_ENC_REST_STATE  CONFIG_BUTTON_MNGR_ENC_REST_STATE
+#else
+#define BUTTON_MNGR_ENC_REST_STATE  0
+#endif
+
+/**
+ * @brief The idle mode wake-up source count (rows, shifters and rockers).
+*/
+#define BUTTON_MNGR_WAKEUP_SRC_CNT  (BUTTON_ROW_COUNT + BUTTON_SHIFTER_COUNT + \
+                                     BUTTON_ROCKER_COUNT)
 
 /**
  * @brief The wheel encoder state.
@@ -80,29 +150,72 @@ typedef enum
   ENCODER_MODE_2,                           /**< The encoder mode 2. */
 } WheelEncoderMode;
 
+/**
+ * @brief The encoder descriptor.
+*/
+typedef struct
+{
+  ZephyrGpio signals[BUTTON_MNGR_ENC_SIG_CNT];  /**< The A and B signals. */
+  WheelButtonIdx incIdx;                        /**< The mode 1 increment button index. */
+  WheelButtonIdx decIdx;                        /**< The mode 1 decrement button index. */
+  WheelEncoderMode mode;                        /**< The encoder mode. */
+  uint8_t state;                                /**< The last two signal states. */
+  uint8_t stepsPerDetent;                       /**< The quadrature steps per detent. */
+  int32_t subSteps;                             /**< The steps accumulated toward a detent. */
+  bool polled;                                  /**< The timer-polled flag, set if the signals have no EXTI line of their own. */
+  bool disabled;                                /**< The disabled flag, set if both signals are on the same pin. */
+  uint8_t pollPorts[BUTTON_MNGR_ENC_SIG_CNT];   /**< The polled port index of each signal. */
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+  EncoderQdec qdec;                             /**< The hardware decoder, unused if no device. */
+#endif
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+  uint32_t stepCycle;                           /**< The cycle count of the last step. */
+  volatile uint32_t stepPeriod;                 /**< The cycles per step between the last two steps. */
+#endif
+} EncoderDesc;
+
 #ifndef CONFIG_ZTEST
+/**
+ * @brief Initialize the signals of an encoder descriptor from the devicetree.
+*/
+#define ENCODER_SIGNALS(a, b)                                                \
+  {                                                                          \
+    { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(a), gpios, {0}) },                 \
+    { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(b), gpios, {0}) },                 \
+  }
+
+/**
+ * @brief Initialize the hardware decoder of an encoder descriptor from the
+ *        devicetree. The encoder uses the GPIO IRQs if the alias is not an
+ *        enabled node.
+*/
+#define ENCODER_QDEC(alias)                                                  \
+  COND_CODE_1(DT_NODE_HAS_STATUS(DT_ALIAS(alias), okay),                     \
+    ({                                                                       \
+      .dev = DEVICE_DT_GET(DT_ALIAS(alias)),                                 \
+      .countsPerRev = DT_PROP(DT_ALIAS(alias), st_counts_per_revolution),    \
+    }),                                                                      \
+    ({ .dev = NULL }))
+
+/**
+ * @brief Initialize a button matrix GPIO from an element of a phandles
+ *        property of the matrix node.
+*/
+#define BUTTON_MATRIX_GPIO(node, prop, idx)                                  \
+  { .dev = GPIO_DT_SPEC_GET(DT_PHANDLE_BY_IDX(node, prop, idx), gpios) },
+
 /**
  * @brief The button matrix rows.
 */
 ZephyrGpio rows[BUTTON_ROW_COUNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row0), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row1), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row2), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row3), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row4), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row5), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row6), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(row7), gpios, {0}) },
+  DT_FOREACH_PROP_ELEM(BUTTON_MATRIX_NODE, rows, BUTTON_MATRIX_GPIO)
 };
 
 /**
  * @brief The button matrix columns.
 */
 ZephyrGpio columns[BUTTON_COL_COUNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(col0), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(col1), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(col2), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(col3), gpios, {0}) },
+  DT_FOREACH_PROP_ELEM(BUTTON_MATRIX_NODE, columns, BUTTON_MATRIX_GPIO)
 };
 
 /**
@@ -120,360 +233,1691 @@ ZephyrGpio rockers[BUTTON_ROCKER_COUNT] = {
   { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(left_rocker), gpios, {0}) },
   { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(right_rocker), gpios, {0}) },
 };
+#else
+#define ENCODER_SIGNALS(a, b)       { 0 }
+#define ENCODER_QDEC(alias)         { .dev = NULL }
+ZephyrGpio rows[BUTTON_ROW_COUNT];
+ZephyrGpio columns[BUTTON_COL_COUNT];
+ZephyrGpio shifters[BUTTON_SHIFTER_COUNT];
+ZephyrGpio rockers[BUTTON_ROCKER_COUNT];
+#endif
+
+/**
+ * @brief The thread stack.
+*/
+K_THREAD_STACK_DEFINE(buttonThreadStack, BUTTON_MNGR_STACK_SIZE);
 
 /**
- * @brief The left encoder signals.
+ * @brief The thread.
 */
-ZephyrGpio leftEncoder[BUTTON_MNGR_ENC_SIG_CNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(left_enc_a), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(left_enc_b), gpios, {0}) },
+static ZephyrThread thread = {
+  .stack = buttonThreadStack,
+  .stackSize = BUTTON_MNGR_STACK_SIZE,
+  .priority = 2,
+  .options = 0,
 };
 
+BUILD_ASSERT(BUTTON_MNGR_MATRIX_KEY_CNT <= 32,
+             "the button matrix must hold at most 32 keys");
+BUILD_ASSERT(DT_PROP_LEN(BUTTON_MATRIX_NODE, key_names) ==
+             BUTTON_MNGR_MATRIX_KEY_CNT,
+             "every button matrix key must be named");
+BUILD_ASSERT(BUTTON_COUNT - TC_INC_IDX <= ATOMIC_BITS,
+             "the encoder buttons must fit in the encoder button word");
+
 /**
- * @brief The right encoder signals.
+ * @brief The matrix, shifter and rocker button states, bit n being the
+ *        button n state. Only written by the button thread, once per scan.
 */
-ZephyrGpio rightEncoder[BUTTON_MNGR_ENC_SIG_CNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(right_enc_a), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(right_enc_b), gpios, {0}) },
-};
+static atomic_t inputBits = ATOMIC_INIT(0);
 
 /**
- * @brief The TC encoder signals.
+ * @brief The encoder button states, bit n being the button TC_INC_IDX + n
+ *        state. Set by the encoder IRQs.
 */
-ZephyrGpio tcEncoder[BUTTON_MNGR_ENC_SIG_CNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(tc_enc_a), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(tc_enc_b), gpios, {0}) },
-};
+static atomic_t encoderBits = ATOMIC_INIT(0);
 
 /**
- * @brief The TC1 encoder signals.
+ * @brief The cycle counter value of the last edge of each button, valid once
+ *        its edge valid bit is set. Stamped at the publishing scan for the
+ *        inputs and in the IRQ for the encoder buttons.
 */
-ZephyrGpio tc1Encoder[BUTTON_MNGR_ENC_SIG_CNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(tc1_enc_a), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(tc1_enc_b), gpios, {0}) },
-};
+static volatile uint32_t edgeCycles[BUTTON_COUNT];
+
+/**
+ * @brief The edge valid bits, bit n being set once the button n changed.
+*/
+static ATOMIC_DEFINE(edgeValid, BUTTON_COUNT);
+
+/**
+ * @brief The cycle counter value of the scan that first saw the current raw
+ *        level of each input button. Only used by the button thread.
+*/
+static uint32_t rawEdgeCycles[TC_INC_IDX];
+
+/**
+ * @brief The raw input button word of the last scan, packed as the input
+ *        button states.
+*/
+static uint32_t rawInputBits = 0;
+
+/**
+ * @brief The encoder button press counts, entry n being the button
+ *        TC_INC_IDX + n. Incremented by the encoder IRQs, never cleared, so
+ *        that every consumer cursor can compare them with its own copy.
+*/
+static atomic_t encPressCounts[BUTTON_ENC_BUTTON_COUNT];
+
+/**
+ * @brief The change event cursor on the encoder buttons.
+*/
+static ButtonMngrCursor eventCursor;
+
+/**
+ * @brief The input button states of the last change event.
+*/
+static uint32_t notifiedInputBits = 0;
+
+/**
+ * @brief The change event subscriber lock.
+*/
+static struct k_spinlock subscriberLock;
+
+/**
+ * @brief The change event subscribers.
+*/
+static struct k_msgq *subscribers[CONFIG_BUTTON_MNGR_SUBSCRIBER_COUNT];
+
+/**
+ * @brief The change event subscriber count, incremented once the new
+ *        subscriber is stored.
+*/
+static atomic_t subscriberCount = ATOMIC_INIT(0);
+
+/**
+ * @brief The polled encoder ports, each one read once per poll.
+*/
+static const struct device *encPollPorts[BUTTON_MNGR_ENC_POLL_PORT_MAX];
+
+/**
+ * @brief The polled encoder port count.
+*/
+static uint8_t encPollPortCount = 0;
+
+/**
+ * @brief The encoder step counters, incremented and decremented by the
+ *        encoder IRQs and exchanged with 0 when read.
+*/
+static atomic_t encSteps[ENCODER_COUNT];
+
+/**
+ * @brief The encoder invalid transition counters.
+*/
+static atomic_t encNoise[ENCODER_COUNT];
+
+/**
+ * @brief The encoder activity flag, set by every encoder step and cleared
+ *        by the button thread once per scan.
+*/
+static atomic_t encActivity = ATOMIC_INIT(0);
+
+/**
+ * @brief The button matrix debouncer.
+*/
+static Debouncer matrixDebouncer;
+
+/**
+ * @brief The shifter debouncer.
+*/
+static Debouncer shifterDebouncer;
+
+/**
+ * @brief The rocker debouncer.
+*/
+static Debouncer rockerDebouncer;
+
+/**
+ * @brief The scan semaphore given by the scan timer.
+*/
+K_SEM_DEFINE(scanSem, 0, 1);
+
+/**
+ * @brief   Scan timer expiry function.
+ *
+ * @param timer   The scan timer.
+ */
+static void scanTimerExpiry(struct k_timer *timer)
+{
+  k_sem_give(&scanSem);
+}
+
+/**
+ * @brief The scan timer.
+*/
+K_TIMER_DEFINE(scanTimer, scanTimerExpiry, NULL);
+
+/**
+ * @brief The scan statistics lock.
+*/
+static struct k_spinlock scanStatsLock;
 
 /**
- * @brief The ABS encoder signals.
+ * @brief The scan statistics.
 */
-ZephyrGpio absEncoder[BUTTON_MNGR_ENC_SIG_CNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(abs_enc_a), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(abs_enc_b), gpios, {0}) },
+static ButtonMngrScanStats scanStats = {
+  .periodUs = BUTTON_MNGR_SCAN_PERIOD_US,
+  .minPeriodUs = UINT32_MAX,
 };
 
 /**
- * @brief The MAP encoder signals.
+ * @brief The cycle count of the last scan.
 */
-ZephyrGpio mapEncoder[BUTTON_MNGR_ENC_SIG_CNT] = {
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(map_enc_a), gpios, {0}) },
-  { .dev = GPIO_DT_SPEC_GET_OR(DT_ALIAS(map_enc_b), gpios, {0}) },
+static uint32_t lastScanCycle;
+
+/**
+ * @brief The scan statistics restart flag. When set, the next scan only
+ *        records its cycle count.
+*/
+static bool scanStatsRestart = true;
+
+/**
+ * @brief The encoder descriptors.
+*/
+static EncoderDesc encoders[ENCODER_COUNT] = {
+  [LEFT_ENC_IDX] = {
+    .signals = ENCODER_SIGNALS(left_enc_a, left_enc_b),
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+    .qdec = ENCODER_QDEC(left_qdec),
+#endif
+    .incIdx = LEFT_ENC_M1_INC_IDX,
+    .decIdx = LEFT_ENC_M1_DEC_IDX,
+    .stepsPerDetent = CONFIG_BUTTON_MNGR_ENC_STEPS_PER_DETENT,
+  },
+  [RIGHT_ENC_IDX] = {
+    .signals = ENCODER_SIGNALS(right_enc_a, right_enc_b),
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+    .qdec = ENCODER_QDEC(right_qdec),
+#endif
+    .incIdx = BB_INC_IDX,
+    .decIdx = BB_DEC_IDX,
+    .stepsPerDetent = CONFIG_BUTTON_MNGR_ENC_STEPS_PER_DETENT,
+  },
+  [TC_ENC_IDX] = {
+    .signals = ENCODER_SIGNALS(tc_enc_a, tc_enc_b),
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+    .qdec = ENCODER_QDEC(tc_qdec),
+#endif
+    .incIdx = TC_INC_IDX,
+    .decIdx = TC_DEC_IDX,
+    .stepsPerDetent = CONFIG_BUTTON_MNGR_ENC_STEPS_PER_DETENT,
+  },
+  [TC1_ENC_IDX] = {
+    .signals = ENCODER_SIGNALS(tc1_enc_a, tc1_enc_b),
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+    .qdec = ENCODER_QDEC(tc1_qdec),
+#endif
+    .incIdx = TC1_INC_IDX,
+    .decIdx = TC1_DEC_IDX,
+    .stepsPerDetent = CONFIG_BUTTON_MNGR_ENC_STEPS_PER_DETENT,
+  },
+  [ABS_ENC_IDX] = {
+    .signals = ENCODER_SIGNALS(abs_enc_a, abs_enc_b),
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+    .qdec = ENCODER_QDEC(abs_qdec),
+#endif
+    .incIdx = ABS_INC_IDX,
+    .decIdx = ABS_DEC_IDX,
+    .stepsPerDetent = CONFIG_BUTTON_MNGR_ENC_STEPS_PER_DETENT,
+  },
+  [MAP_ENC_IDX] = {
+    .signals = ENCODER_SIGNALS(map_enc_a, map_enc_b),
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+    .qdec = ENCODER_QDEC(map_qdec),
+#endif
+    .incIdx = MAP_INC_IDX,
+    .decIdx = MAP_DEC_IDX,
+    .stepsPerDetent = CONFIG_BUTTON_MNGR_ENC_STEPS_PER_DETENT,
+  },
 };
-#else
-ZephyrGpio rows[BUTTON_ROW_COUNT];
-ZephyrGpio columns[BUTTON_COL_COUNT];
-ZephyrGpio shifters[BUTTON_SHIFTER_COUNT];
-ZephyrGpio rockers[BUTTON_ROCKER_COUNT];
-ZephyrGpio leftEncoder[BUTTON_MNGR_ENC_SIG_CNT];
-ZephyrGpio rightEncoder[BUTTON_MNGR_ENC_SIG_CNT];
-ZephyrGpio tcEncoder[BUTTON_MNGR_ENC_SIG_CNT];
-ZephyrGpio tc1Encoder[BUTTON_MNGR_ENC_SIG_CNT];
-ZephyrGpio absEncoder[BUTTON_MNGR_ENC_SIG_CNT];
-ZephyrGpio mapEncoder[BUTTON_MNGR_ENC_SIG_CNT];
+
+/**
+ * @brief The quadrature decoding table, indexed by the previous and current
+ *        A/B signal states (prev A, prev B, curr A, curr B).
+*/
+static const int8_t encLookup[16] = {0, -1, 1, 0, 1, 0, 0, -1,
+                                     -1, 0, 0, 1, 0, 1, -1, 0};
+
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+/**
+ * @brief The idle mode wake-up semaphore.
+*/
+K_SEM_DEFINE(wakeupSem, 0, 1);
+
+/**
+ * @brief The idle flag, set while the button thread waits for a wake-up.
+*/
+static atomic_t idleFlag = ATOMIC_INIT(0);
+
+/**
+ * @brief The idle mode wake-up sources.
+*/
+static ZephyrGpio *wakeupSources[BUTTON_MNGR_WAKEUP_SRC_CNT];
+
+/**
+ * @brief The idle mode wake-up interrupt availability flag. The button thread
+ *        keeps scanning instead of going idle if unset.
+*/
+static bool wakeupIrqAvailable = false;
 #endif
 
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
 /**
- * @brief The thread stack.
+ * @brief The button matrix row port group.
 */
-K_THREAD_STACK_DEFINE(buttonThreadStack, BUTTON_MNGR_STACK_SIZE);
+typedef struct
+{
+  const struct device *port;                /**< The group GPIO port. */
+  gpio_port_pins_t mask;                    /**< The group row pin mask. */
+} MatrixPortGroup;
 
 /**
- * @brief The thread.
+ * @brief The button matrix row port groups.
 */
-static ZephyrThread thread = {
-  .stack = buttonThreadStack,
-  .stackSize = BUTTON_MNGR_STACK_SIZE,
-  .priority = 2,
-  .options = 0,
-};
+static MatrixPortGroup rowPortGroups[BUTTON_ROW_COUNT];
 
 /**
- * @brief The button states.
+ * @brief The button matrix row port group count.
 */
-static WheelButtonState buttonStates[BUTTON_COUNT];
+static uint8_t rowPortGroupCount = 0;
 
 /**
- * @brief The encoder modes.
+ * @brief The port group index of each button matrix row.
 */
-static WheelEncoderMode encModes[RIGHT_ENC_IDX + 1] = {ENCODER_MODE_1,
-                                                       ENCODER_MODE_1};
+static uint8_t rowPortGroupIdx[BUTTON_ROW_COUNT];
+#endif
 
 /**
- * @brief The encoder signal states.
+ * @brief The raw matrix word of the last scan.
 */
-static uint8_t encSigStates[ENCODER_COUNT] = {0, 0, 0, 0, 0, 0};
+static uint32_t matrixRaw = 0;
 
 /**
- * @brief   Process encoder signals to get its state.
+ * @brief The raw shifter word of the last read.
+*/
+static uint32_t shifterRaw = 0;
+
+/**
+ * @brief The raw rocker word of the last read.
+*/
+static uint32_t rockerRaw = 0;
+
+/**
+ * @brief The column settle time [cycles], the maximal one until calibrated.
+*/
+static uint32_t settleCycles = 0;
+
+/**
+ * @brief The settle time calibration request flag, set by the calibration
+ *        API and cleared by the button thread.
+*/
+static atomic_t settleCalibRequest = ATOMIC_INIT(0);
+
+/**
+ * @brief The settle time calibration semaphore given once a requested
+ *        calibration is done.
+*/
+K_SEM_DEFINE(settleCalibSem, 0, 1);
+
+/**
+ * @brief The result of the last requested settle time calibration.
+*/
+static int settleCalibRc = 0;
+
+/**
+ * @brief   Read the encoder signals. Both signals are sampled in a single port
+ *          read when they share the same port.
  *
- * @param gpios       The encoder GPIO signals.
- * @param states      The encoder signal states.
+ * @param enc     The encoder descriptor.
+ * @param sigA    The A signal state.
+ * @param sigB    The B signal state.
  *
- * @return  The processed encoder state.
+ * @return  0 if successful, the error code otherwise.
  */
-static WheelEncoderState processEncoderIrq(ZephyrGpio *gpios, uint8_t *states)
+static int readEncoderSignals(EncoderDesc *enc, int *sigA, int *sigB)
 {
-  ZephyrGpioState gpioState;
-  WheelEncoderState encState;
-  int8_t lookup[] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+  int rc;
+  gpio_port_value_t value;
 
-  *states = (*states << 2) & 0x0f;
-  for(uint8_t i = 0; i < BUTTON_MNGR_ENC_SIG_CNT; ++i)
+  if(enc->signals[0].dev.port == enc->signals[1].dev.port)
   {
-    gpioState = zephyrGpioRead(gpios + i);
-    if(gpioState < 0)
-      // TODO: fatal error management.
-      LOG_ERR("unable to read encoder GPIO %s", gpios[i].dev.port->name);
-    if(i == 0)
-      *states |= ((uint8_t)gpioState << 1);
-    else
-      *states |= (uint8_t)gpioState;
+    rc = gpioPortRead(enc->signals[0].dev.port, &value);
+    if(rc < 0)
+      return rc;
+
+    *sigA = (value >> enc->signals[0].dev.pin) & 1;
+    *sigB = (value >> enc->signals[1].dev.pin) & 1;
+    return 0;
   }
 
-  if(lookup[*states] > 0)
-    encState = ENCODER_INCREMENT;
-  else if(lookup[*states] < 0)
-    encState = ENCODER_DECREMENT;
-  else
-    encState = ENCODER_NO_CHANGE;
+  *sigA = zephyrGpioRead(enc->signals);
+  if(*sigA < 0)
+    return *sigA;
+
+  *sigB = zephyrGpioRead(enc->signals + 1);
+  if(*sigB < 0)
+    return *sigB;
 
-  return encState;
+  return 0;
 }
 
 /**
- * @brief   Left encoder GPIO IRQ.
+ * @brief   Update the state machine of an encoder with its signals.
  *
- * @param dev         The device structure of the GPIO causing the IRQ.
- * @param cb          The IRQ callback structure.
- * @param pin         The pin number of the GPIO that triggered the interrupt.
+ * @param enc     The encoder descriptor.
+ * @param sigA    The A signal state.
+ * @param sigB    The B signal state.
+ *
+ * @return  The processed encoder state.
  */
-static void leftEncoderIrq(const struct device *dev, struct gpio_callback *cb,
-                           uint32_t pin)
+static WheelEncoderState updateEncoderState(EncoderDesc *enc, int sigA,
+                                            int sigB)
 {
-  WheelEncoderState state;
+  enc->state = ((enc->state << 2) & 0x0f) | (sigA << 1) | sigB;
 
-  state = processEncoderIrq(leftEncoder, encSigStates + LEFT_ENC_IDX);
+  /* both signals changed at once, a transition was missed */
+  if((((enc->state >> 2) ^ enc->state) & 0x03) == 0x03)
+    atomic_inc(encNoise + (enc - encoders));
 
-  if(state == ENCODER_INCREMENT)
-    buttonStates[LEFT_ENC_M1_INC_IDX + encModes[LEFT_ENC_IDX]] = BUTTON_PRESSED;
-  else if(state == ENCODER_DECREMENT)
-    buttonStates[LEFT_ENC_M1_DEC_IDX + encModes[LEFT_ENC_IDX]] = BUTTON_PRESSED;
+  if(encLookup[enc->state] > 0)
+    return ENCODER_INCREMENT;
+
+  if(encLookup[enc->state] < 0)
+    return ENCODER_DECREMENT;
+
+  return ENCODER_NO_CHANGE;
 }
 
 /**
- * @brief   Right encoder GPIO IRQ.
+ * @brief   Process encoder signals to get its state.
  *
- * @param dev         The device structure of the GPIO causing the IRQ.
- * @param cb          The IRQ callback structure.
- * @param pin         The pin number of the GPIO that triggered the interrupt.
+ * @param enc     The encoder descriptor.
+ *
+ * @return  The processed encoder state.
  */
-static void rightEncoderIrq(const struct device *dev, struct gpio_callback *cb,
-                            uint32_t pin)
+static WheelEncoderState processEncoderIrq(EncoderDesc *enc)
 {
-  WheelEncoderState state;
+  int sigA;
+  int sigB;
 
-  state = processEncoderIrq(rightEncoder, encSigStates + RIGHT_ENC_IDX);
+  if(readEncoderSignals(enc, &sigA, &sigB) < 0)
+  {
+    // TODO: fatal error management.
+    LOG_ERR("unable to read encoder %d signals", (int)(enc - encoders));
+    return ENCODER_NO_CHANGE;
+  }
 
-  if(state == ENCODER_INCREMENT)
-    buttonStates[BB_INC_IDX + encModes[RIGHT_ENC_IDX]] = BUTTON_PRESSED;
-  else if(state == ENCODER_DECREMENT)
-    buttonStates[BB_DEC_IDX + encModes[RIGHT_ENC_IDX]] = BUTTON_PRESSED;
+  return updateEncoderState(enc, sigA, sigB);
 }
 
 /**
- * @brief   TC encoder GPIO IRQ.
+ * @brief   Check if an encoder is decoded by its GPIO IRQs, i.e. it is neither
+ *          disabled, polled nor hardware decoded.
  *
- * @param dev         The device structure of the GPIO causing the IRQ.
- * @param cb          The IRQ callback structure.
- * @param pin         The pin number of the GPIO that triggered the interrupt.
+ * @param enc     The encoder descriptor.
+ *
+ * @return  true if the encoder uses its IRQs, false otherwise.
  */
-static void tcEncoderIrq(const struct device *dev, struct gpio_callback *cb,
-                         uint32_t pin)
+static bool isEncoderIrqDriven(const EncoderDesc *enc)
 {
-  WheelEncoderState state;
-
-  state = processEncoderIrq(tcEncoder, encSigStates + TC_ENC_IDX);
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+  if(enc->qdec.dev)
+    return false;
+#endif
 
-  if(state == ENCODER_INCREMENT)
-    buttonStates[TC_INC_IDX] = BUTTON_PRESSED;
-  else if(state == ENCODER_DECREMENT)
-    buttonStates[TC_DEC_IDX] = BUTTON_PRESSED;
+  return !enc->disabled && !enc->polled;
 }
 
 /**
- * @brief   TC1 encoder GPIO IRQ.
+ * @brief   Get the encoder descriptor of an IRQ callback. The callback
+ *          structure is embedded in the encoder signal GPIOs, themselves
+ *          embedded in the descriptor.
  *
- * @param dev         The device structure of the GPIO causing the IRQ.
- * @param cb          The IRQ callback structure.
- * @param pin         The pin number of the GPIO that triggered the interrupt.
+ * @param cb      The IRQ callback structure.
+ *
+ * @return  The encoder descriptor, NULL if the callback is not an encoder one.
  */
-static void tc1EncoderIrq(const struct device *dev, struct gpio_callback *cb,
-                          uint32_t pin)
+static EncoderDesc *getEncoderFromCallback(struct gpio_callback *cb)
 {
-  WheelEncoderState state;
+  uintptr_t offset = (uintptr_t)cb - (uintptr_t)encoders;
 
-  state = processEncoderIrq(tc1Encoder, encSigStates + TC1_ENC_IDX);
+  if((uintptr_t)cb < (uintptr_t)encoders || offset >= sizeof(encoders))
+    return NULL;
 
-  if(state == ENCODER_INCREMENT)
-    buttonStates[TC1_INC_IDX] = BUTTON_PRESSED;
-  else if(state == ENCODER_DECREMENT)
-    buttonStates[TC1_DEC_IDX] = BUTTON_PRESSED;
+  return encoders + offset / sizeof(EncoderDesc);
 }
 
 /**
- * @brief   ABS encoder GPIO IRQ.
+ * @brief   Press an encoder button.
  *
- * @param dev         The device structure of the GPIO causing the IRQ.
- * @param cb          The IRQ callback structure.
- * @param pin         The pin number of the GPIO that triggered the interrupt.
+ * @param idx   The encoder button index.
  */
-static void absEncoderIrq(const struct device *dev, struct gpio_callback *cb,
-                          uint32_t pin)
+static inline void pressEncoderButton(WheelButtonIdx idx)
 {
-  WheelEncoderState state;
-
-  state = processEncoderIrq(absEncoder, encSigStates + ABS_ENC_IDX);
-
-  if(state == ENCODER_INCREMENT)
-    buttonStates[ABS_INC_IDX] = BUTTON_PRESSED;
-  else if(state == ENCODER_DECREMENT)
-    buttonStates[ABS_DEC_IDX] = BUTTON_PRESSED;
+  edgeCycles[idx] = k_cycle_get_32();
+  atomic_set_bit(edgeValid, idx);
+  atomic_set_bit(&encoderBits, idx - TC_INC_IDX);
+  atomic_inc(encPressCounts + idx - TC_INC_IDX);
 }
 
 /**
- * @brief   MAP encoder GPIO IRQ.
+ * @brief   Read the encoder buttons pressed since the last read of a cursor
+ *          and move the cursor to the current presses.
  *
- * @param dev         The device structure of the GPIO causing the IRQ.
+ * @param cursor  The consumer cursor.
+ *
+ * @return  The pressed encoder buttons, bit n being the button
+ *          TC_INC_IDX + n.
+ */
+static uint32_t readEncoderPresses(ButtonMngrCursor *cursor)
+{
+  uint32_t count;
+  uint32_t presses = 0;
+
+  for(uint8_t i = 0; i < BUTTON_ENC_BUTTON_COUNT; ++i)
+  {
+    count = (uint32_t)atomic_get(encPressCounts + i);
+    if(count != cursor->pressCounts[i])
+      presses |= BIT(i);
+
+    cursor->pressCounts[i] = count;
+  }
+
+  return presses;
+}
+
+/**
+ * @brief   Add steps to an encoder and press its increment or decrement
+ *          button.
+ *
+ * @param enc     The encoder descriptor.
+ * @param steps   The signed step count.
+ */
+static void addEncoderSteps(EncoderDesc *enc, int32_t steps)
+{
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+  uint32_t now;
+#endif
+
+  if(steps == 0)
+    return;
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+  /* measured first so that the steps are never newer than their period */
+  now = k_cycle_get_32();
+  enc->stepPeriod = (now - enc->stepCycle) / ABS(steps);
+  enc->stepCycle = now;
+#endif
+  atomic_add(encSteps + (enc - encoders), steps);
+  atomic_set(&encActivity, 1);
+
+  if(steps > 0)
+    pressEncoderButton(enc->incIdx + enc->mode);
+  else
+    pressEncoderButton(enc->decIdx + enc->mode);
+}
+
+/**
+ * @brief   Accumulate quadrature steps into detents. On the rest state, the
+ *          accumulation is resynchronized: a partial detent past its half
+ *          counts as a detent and the rest is dropped.
+ *
+ * @param enc     The encoder descriptor.
+ * @param steps   The quadrature steps.
+ * @param atRest  The rest state flag.
+ *
+ * @return  The detents completed by these steps.
+ */
+static int32_t accumulateEncoderSteps(EncoderDesc *enc, int32_t steps,
+                                      bool atRest)
+{
+  int32_t detents;
+
+  enc->subSteps += steps;
+  detents = enc->subSteps / enc->stepsPerDetent;
+  enc->subSteps -= detents * enc->stepsPerDetent;
+
+  if(atRest)
+  {
+    if(2 * ABS(enc->subSteps) > enc->stepsPerDetent)
+      detents += enc->subSteps > 0 ? 1 : -1;
+    enc->subSteps = 0;
+  }
+
+  return detents;
+}
+
+/**
+ * @brief   Count the steps of an encoder state.
+ *
+ * @param enc     The encoder descriptor.
+ * @param state   The processed encoder state.
+ */
+static void stepEncoder(EncoderDesc *enc, WheelEncoderState state)
+{
+  int32_t steps = 0;
+  int32_t detents;
+  bool atRest;
+
+  if(state == ENCODER_INCREMENT)
+    steps = 1;
+  else if(state == ENCODER_DECREMENT)
+    steps = -1;
+
+  atRest = IS_ENABLED(CONFIG_BUTTON_MNGR_ENC_REST_RESYNC) &&
+    (enc->state & 0x03) == BUTTON_MNGR_ENC_REST_STATE;
+
+  detents = accumulateEncoderSteps(enc, steps, atRest);
+  addEncoderSteps(enc, detents);
+
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+  /* the subscribers only get the step once the button thread scans again */
+  if(detents != 0 && atomic_get(&idleFlag))
+    k_sem_give(&wakeupSem);
+#endif
+}
+
+/**
+ * @brief   Encoder GPIO IRQ, shared by all the encoders.
+ *
+ * @param dev         The device structure of the GPIO causing the IRQ.
+ * @param cb          The IRQ callback structure.
+ * @param pin         The pin number of the GPIO that triggered the interrupt.
+ */
+static void encoderIrq(const struct device *dev, struct gpio_callback *cb,
+                       uint32_t pin)
+{
+  EncoderDesc *enc;
+
+  enc = getEncoderFromCallback(cb);
+  if(!enc)
+    return;
+
+  stepEncoder(enc, processEncoderIrq(enc));
+}
+
+/**
+ * @brief   Encoder poll timer expiry function. Every polled encoder port is
+ *          read once, then the polled encoders are decoded from the port
+ *          values. The encoders on a port that cannot be read are skipped.
+ *
+ * @param timer   The encoder poll timer.
+ */
+static void encoderPollExpiry(struct k_timer *timer)
+{
+  gpio_port_value_t values[BUTTON_MNGR_ENC_POLL_PORT_MAX];
+  uint32_t failedPorts = 0;
+  EncoderDesc *enc;
+  int sigA;
+  int sigB;
+
+  for(uint8_t port = 0; port < encPollPortCount; ++port)
+  {
+    if(gpioPortRead(encPollPorts[port], values + port) < 0)
+      failedPorts |= BIT(port);
+  }
+
+  for(enc = encoders; enc < encoders + ENCODER_COUNT; ++enc)
+  {
+    if(!enc->polled || failedPorts & (BIT(enc->pollPorts[0]) |
+                                      BIT(enc->pollPorts[1])))
+      continue;
+
+    sigA = (values[enc->pollPorts[0]] >> enc->signals[0].dev.pin) & 1;
+    sigB = (values[enc->pollPorts[1]] >> enc->signals[1].dev.pin) & 1;
+    stepEncoder(enc, updateEncoderState(enc, sigA, sigB));
+  }
+}
+
+/**
+ * @brief The encoder poll timer.
+*/
+K_TIMER_DEFINE(encoderPollTimer, encoderPollExpiry, NULL);
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+/**
+ * @brief   Read the counts of the hardware decoded encoders.
+ *
+ * @return  true if any of these encoders moved, false otherwise.
+ */
+static bool readQdecEncoders(void)
+{
+  int rc;
+  int32_t delta;
+  bool moved = false;
+
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
+  {
+    if(!encoders[i].qdec.dev)
+      continue;
+
+    rc = encoderQdecReadDelta(&encoders[i].qdec, &delta);
+    if(rc < 0)
+    {
+      LOG_ERR("unable to read encoder %d decoder", i);
+      continue;
+    }
+
+    addEncoderSteps(encoders + i,
+      accumulateEncoderSteps(encoders + i, delta, false));
+    moved = moved || delta != 0;
+  }
+
+  return moved;
+}
+#endif
+
+/**
+ * @brief   Pack the input button words in a single word. The shifter and
+ *          rocker words override their matrix slots.
+ *
+ * @param matrix    The matrix word.
+ * @param shifters  The shifter word.
+ * @param rockers   The rocker word.
+ *
+ * @return  The packed input button word.
+ */
+static uint32_t packInputBits(uint32_t matrix, uint32_t shifters,
+                              uint32_t rockers)
+{
+  uint32_t bits;
+
+  bits = matrix & ~(BUTTON_MNGR_SHIFTER_MASK | BUTTON_MNGR_ROCKER_MASK);
+  bits |= (shifters << LEFT_SHIFTER_IDX) & BUTTON_MNGR_SHIFTER_MASK;
+  bits |= (rockers << LEFT_ROCKER_IDX) & BUTTON_MNGR_ROCKER_MASK;
+
+  return bits;
+}
+
+/**
+ * @brief   Stamp the raw input changes of a scan, before debouncing.
+ *
+ * @param cycle   The scan cycle counter value.
+ */
+static void stampRawEdges(uint32_t cycle)
+{
+  uint32_t raw;
+  uint32_t changed;
+
+  raw = packInputBits(matrixRaw, shifterRaw, rockerRaw);
+  changed = raw ^ rawInputBits;
+  while(changed)
+  {
+    rawEdgeCycles[u32_count_trailing_zeros(changed)] = cycle;
+    changed &= changed - 1;
+  }
+
+  rawInputBits = raw;
+}
+
+/**
+ * @brief   Publish the input button states of a scan in a single store. The
+ *          changed buttons are stamped with the scan that first saw their
+ *          new raw level.
+ *
+ * @param matrix    The debounced matrix states.
+ * @param shifters  The debounced shifter states.
+ * @param rockers   The debounced rocker states.
+ */
+static void publishInputStates(uint32_t matrix, uint32_t shifters,
+                               uint32_t rockers)
+{
+  uint32_t bits;
+  uint32_t changed;
+  uint8_t idx;
+
+  bits = packInputBits(matrix, shifters, rockers);
+
+  /* stamped before the store so that a new state is never older than its
+   * timestamp */
+  changed = bits ^ (uint32_t)atomic_get(&inputBits);
+  while(changed)
+  {
+    idx = u32_count_trailing_zeros(changed);
+    edgeCycles[idx] = rawEdgeCycles[idx];
+    atomic_set_bit(edgeValid, idx);
+    changed &= changed - 1;
+  }
+
+  atomic_set(&inputBits, (atomic_val_t)bits);
+}
+
+/**
+ * @brief   Post a change event to the subscribers if any button changed
+ *          since the last event.
+ *
+ * @param cycle   The scan cycle counter value.
+ */
+static void notifySubscribers(uint32_t cycle)
+{
+  uint32_t inputs;
+  uint32_t encoders;
+  uint32_t count;
+  WheelButtonBits changed;
+  ButtonMngrEvent event;
+
+  inputs = (uint32_t)atomic_get(&inputBits);
+  encoders = readEncoderPresses(&eventCursor);
+
+  if(inputs == notifiedInputBits && encoders == 0)
+    return;
+
+  event.changed = (WheelButtonBits)(inputs ^ notifiedInputBits) |
+    ((WheelButtonBits)encoders << TC_INC_IDX);
+  event.states = (WheelButtonBits)inputs |
+    ((WheelButtonBits)encoders << TC_INC_IDX);
+  event.cycle = cycle;
+  notifiedInputBits = inputs;
+
+  event.edgeCount = 0;
+  for(changed = event.changed; changed != 0 &&
+      event.edgeCount < BUTTON_MNGR_EVENT_EDGE_MAX; changed &= changed - 1)
+  {
+    event.edges[event.edgeCount].idx = u64_count_trailing_zeros(changed);
+    event.edges[event.edgeCount].cycle =
+      edgeCycles[event.edges[event.edgeCount].idx];
+    ++event.edgeCount;
+  }
+
+  count = (uint32_t)atomic_get(&subscriberCount);
+  for(uint32_t i = 0; i < count; ++i)
+  {
+    if(k_msgq_put(subscribers[i], &event, K_NO_WAIT) < 0)
+      LOG_WRN("subscriber %u missed a button event", i);
+  }
+}
+
+/**
+ * @brief   Get the keys of the columns forming a ghosting rectangle in a raw
+ *          matrix word: two columns sharing two or more active rows, where
+ *          one key may be a ghost of the three others.
+ *
+ * @param raw   The raw matrix word.
+ *
+ * @return  The keys of the ambiguous columns, 0 if there are none.
+ */
+static uint32_t getGhostKeys(uint32_t raw)
+{
+  uint32_t colRows;
+  uint32_t sharedRows;
+  uint32_t ghostKeys = 0;
+
+  for(uint8_t col = 0; col < BUTTON_COL_COUNT - 1; ++col)
+  {
+    colRows = (raw >> (BUTTON_ROW_COUNT * col)) & BUTTON_MNGR_COL_ROW_MASK;
+
+    /* a column needs two active rows to be part of a rectangle */
+    if((colRows & (colRows - 1)) == 0)
+      continue;
+
+    for(uint8_t other = col + 1; other < BUTTON_COL_COUNT; ++other)
+    {
+      sharedRows = colRows & (raw >> (BUTTON_ROW_COUNT * other));
+      if((sharedRows & (sharedRows - 1)) != 0)
+        ghostKeys |= (BUTTON_MNGR_COL_ROW_MASK << (BUTTON_ROW_COUNT * col)) |
+          (BUTTON_MNGR_COL_ROW_MASK << (BUTTON_ROW_COUNT * other));
+    }
+  }
+
+  return ghostKeys;
+}
+
+/**
+ * @brief   Filter the ghosting rectangles of a raw matrix word. The ghosting
+ *          scans are counted and, if suppressed, the ambiguous columns keep
+ *          their last raw states.
+ *
+ * @param raw   The raw matrix word.
+ *
+ * @return  The filtered raw matrix word.
+ */
+static uint32_t filterGhostKeys(uint32_t raw)
+{
+  uint32_t ghostKeys;
+  k_spinlock_key_t key;
+
+  ghostKeys = getGhostKeys(raw);
+  if(ghostKeys == 0)
+    return raw;
+
+  key = k_spin_lock(&scanStatsLock);
+  ++scanStats.ghostCount;
+  k_spin_unlock(&scanStatsLock, key);
+
+  if(IS_ENABLED(CONFIG_BUTTON_MNGR_GHOST_SUPPRESS))
+    raw = (raw & ~ghostKeys) | (matrixRaw & ghostKeys);
+
+  return raw;
+}
+
+/**
+ * @brief   Wait for the column settle time once a column is driven.
+ */
+static inline void waitColumnSettle(void)
+{
+  uint32_t start;
+
+  if(settleCycles == 0)
+    return;
+
+  start = k_cycle_get_32();
+  while(k_cycle_get_32() - start < settleCycles)
+    arch_nop();
+}
+
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
+/**
+ * @brief   Group the button matrix rows by GPIO port and build the pin mask
+ *          of each port group.
+ */
+static void initMatrixPortGroups(void)
+{
+  uint8_t group;
+
+  rowPortGroupCount = 0;
+  for(uint8_t row = 0; row < BUTTON_ROW_COUNT; ++row)
+  {
+    group = 0;
+    while(group < rowPortGroupCount &&
+          rowPortGroups[group].port != rows[row].dev.port)
+      ++group;
+
+    if(group == rowPortGroupCount)
+    {
+      rowPortGroups[group].port = rows[row].dev.port;
+      rowPortGroups[group].mask = 0;
+      ++rowPortGroupCount;
+    }
+
+    rowPortGroups[group].mask |= BIT(rows[row].dev.pin);
+    rowPortGroupIdx[row] = group;
+  }
+}
+
+#ifdef CONFIG_BUTTON_MNGR_ANY_KEY_SCAN
+/**
+ * @brief   Check if any matrix key is pressed by driving all the columns
+ *          together and reading each row port once.
+ *
+ * @param anyPressed  The any key pressed flag.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int isAnyKeyPressed(bool *anyPressed)
+{
+  int rc = 0;
+  int clearRc;
+  gpio_port_value_t value;
+
+  *anyPressed = false;
+
+  for(uint8_t col = 0; col < BUTTON_COL_COUNT && rc == 0; ++col)
+    rc = zephyrGpioSet(columns + col);
+
+  if(rc == 0)
+    waitColumnSettle();
+
+  for(uint8_t group = 0; group < rowPortGroupCount && rc == 0 &&
+      !*anyPressed; ++group)
+  {
+    rc = gpioPortRead(rowPortGroups[group].port, &value);
+    *anyPressed = rc == 0 && (value & rowPortGroups[group].mask) != 0;
+  }
+
+  for(uint8_t col = 0; col < BUTTON_COL_COUNT; ++col)
+  {
+    clearRc = zephyrGpioClear(columns + col);
+    if(rc == 0)
+      rc = clearRc;
+  }
+
+  return rc;
+}
+#endif
+
+/**
+ * @brief   Scan the raw button matrix. Each row port is read once per column
+ *          and the row bits are then scattered into the raw matrix word.
+ *
+ * @param raw   The raw matrix word, left untouched on error.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int scanButtonMatrix(uint32_t *raw)
+{
+  int rc;
+  int clearRc;
+  uint32_t bits = 0;
+  gpio_port_value_t portValues[BUTTON_ROW_COUNT];
+
+  for(uint8_t col = 0; col < BUTTON_COL_COUNT; ++col)
+  {
+    /* set the column to read */
+    rc = zephyrGpioSet(columns + col);
+    if(rc < 0)
+      return rc;
+
+    waitColumnSettle();
+
+    for(uint8_t group = 0; group < rowPortGroupCount && rc == 0; ++group)
+    {
+      rc = gpioPortRead(rowPortGroups[group].port, portValues + group);
+      portValues[group] &= rowPortGroups[group].mask;
+    }
+
+    /* clear the column read */
+    clearRc = zephyrGpioClear(columns + col);
+    if(rc == 0)
+      rc = clearRc;
+    if(rc < 0)
+      return rc;
+
+    for(uint8_t row = 0; row < BUTTON_ROW_COUNT; ++row)
+      bits |= ((portValues[rowPortGroupIdx[row]] >> rows[row].dev.pin) & 1) <<
+        (BUTTON_ROW_COUNT * col + row);
+  }
+
+  *raw = bits;
+
+  return 0;
+}
+#else
+/**
+ * @brief   Scan the raw button matrix.
+ *
+ * @param raw   The raw matrix word, left untouched on error.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int scanButtonMatrix(uint32_t *raw)
+{
+  int rc;
+  int buttonState = 0;
+  bool keepReading = true;
+  uint32_t bits = 0;
+
+  for(uint8_t col = 0; col < BUTTON_COL_COUNT && keepReading; ++col)
+  {
+    /* set the column to read */
+    rc = zephyrGpioSet(columns + col);
+    if(rc < 0)
+      return rc;
+
+    waitColumnSettle();
+
+    for(uint8_t row = 0; row < BUTTON_ROW_COUNT && buttonState >= 0; ++row)
+    {
+      buttonState = zephyrGpioRead(rows + row);
+      if(buttonState < 0)
+        keepReading = false;
+      else
+        bits |= (uint32_t)buttonState << (BUTTON_ROW_COUNT * col + row);
+    }
+
+    /* clear the column read */
+    rc = zephyrGpioClear(columns + col);
+    if(rc < 0)
+      keepReading = false;
+  }
+
+  if(buttonState < 0)
+    rc = buttonState;
+
+  if(rc == 0)
+    *raw = bits;
+
+  return rc;
+}
+#endif
+
+/**
+ * @brief   Read the button matrix. The raw matrix word is filtered for
+ *          ghosting and debounced into the matrix states. While no key is
+ *          held, the columns are only scanned if the any-key check is
+ *          positive.
+ *
+ * @param states  The debounced matrix states, left untouched on error.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int readButtonMatrix(uint32_t *states)
+{
+  int rc;
+  uint32_t raw;
+#ifdef CONFIG_BUTTON_MNGR_ANY_KEY_SCAN
+  bool anyPressed;
+
+  if(matrixRaw == 0)
+  {
+    rc = isAnyKeyPressed(&anyPressed);
+    if(rc < 0)
+      return rc;
+
+    if(!anyPressed)
+    {
+      *states = debounceUpdate(&matrixDebouncer, 0);
+      return 0;
+    }
+  }
+#endif
+
+  rc = scanButtonMatrix(&raw);
+  if(rc < 0)
+    return rc;
+
+  raw = filterGhostKeys(raw);
+  matrixRaw = raw;
+  *states = debounceUpdate(&matrixDebouncer, raw);
+
+  return 0;
+}
+
+/**
+ * @brief   Check if the raw matrix scans with a column settle time all match
+ *          a reference scan.
+ *
+ * @param cycles      The column settle time [cycles].
+ * @param reference   The reference raw matrix word.
+ * @param stable      The stable scans flag.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int checkSettleTime(uint32_t cycles, uint32_t reference, bool *stable)
+{
+  int rc = 0;
+  uint32_t raw;
+
+  settleCycles = cycles;
+  *stable = true;
+
+  for(uint16_t i = 0; i < CONFIG_BUTTON_MNGR_SETTLE_CALIB_SCANS && rc == 0 &&
+      *stable; ++i)
+  {
+    rc = scanButtonMatrix(&raw);
+    *stable = rc == 0 && raw == reference;
+  }
+
+  return rc;
+}
+
+/**
+ * @brief   Calibrate the column settle time. The matrix is scanned with
+ *          increasing settle times until the scans match a reference scan
+ *          done with the maximal settle time. The settle time is then one
+ *          calibration step above the first stable one, the maximal one if
+ *          none is stable. A row only rises through a held key, so the
+ *          calibration needs keys held in each column and keeps the
+ *          current settle time without any.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int calibrateSettleTime(void)
+{
+  int rc;
+  uint32_t reference;
+  uint32_t cycles = 0;
+  uint32_t current = settleCycles;
+  bool stable = false;
+
+  settleCycles = BUTTON_MNGR_SETTLE_MAX_CYCLES;
+  rc = scanButtonMatrix(&reference);
+  if(rc == 0 && reference == 0)
+  {
+    LOG_WRN("no key held, column settle time unchanged");
+    settleCycles = current;
+    return -ENODATA;
+  }
+
+  while(rc == 0 && !stable && cycles < BUTTON_MNGR_SETTLE_MAX_CYCLES)
+  {
+    rc = checkSettleTime(cycles, reference, &stable);
+    if(!stable)
+      cycles += BUTTON_MNGR_SETTLE_STEP_CYCLES;
+  }
+
+  settleCycles = MIN(cycles + BUTTON_MNGR_SETTLE_STEP_CYCLES,
+                     BUTTON_MNGR_SETTLE_MAX_CYCLES);
+  if(rc < 0 || !stable)
+    settleCycles = BUTTON_MNGR_SETTLE_MAX_CYCLES;
+
+  LOG_INF("column settle time: %u ns", k_cyc_to_ns_near32(settleCycles));
+
+  return rc;
+}
+
+/**
+ * @brief   Read the shifter buttons.
+ *
+ * @param states  The debounced shifter states, left untouched on error.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int readButtonShifters(uint32_t *states)
+{
+  int rc = 0;
+  uint32_t raw = 0;
+
+  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT && rc >= 0; ++i)
+  {
+    rc = zephyrGpioRead(shifters + i);
+    if(rc >= 0)
+      raw |= (uint32_t)rc << i;
+  }
+
+  if(rc < 0)
+    return rc;
+
+  shifterRaw = raw;
+  *states = debounceUpdate(&shifterDebouncer, raw);
+
+  return 0;
+}
+
+/**
+ * @brief   Read the rocker buttons.
+ *
+ * @param states  The debounced rocker states, left untouched on error.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int readButtonRockers(uint32_t *states)
+{
+  int rc = 0;
+  uint32_t raw = 0;
+
+  for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT && rc >= 0; ++i)
+  {
+    rc = zephyrGpioRead(rockers + i);
+    if(rc >= 0)
+      raw |= (uint32_t)rc << i;
+  }
+
+  if(rc < 0)
+    return rc;
+
+  rockerRaw = raw;
+  *states = debounceUpdate(&rockerDebouncer, raw);
+
+  return 0;
+}
+
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+/**
+ * @brief   Idle mode wake-up GPIO IRQ.
+ *
+ * @param dev         The device structure of the GPIO causing the IRQ.
  * @param cb          The IRQ callback structure.
  * @param pin         The pin number of the GPIO that triggered the interrupt.
  */
-static void mapEncoderIrq(const struct device *dev, struct gpio_callback *cb,
-                          uint32_t pin)
+static void wakeupIrq(const struct device *dev, struct gpio_callback *cb,
+                      uint32_t pin)
 {
-  WheelEncoderState state;
+  k_sem_give(&wakeupSem);
+}
+
+/**
+ * @brief   Disarm the idle mode wake-up interrupts and clear all the
+ *          columns.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int exitIdleMode(void)
+{
+  int rc = 0;
+  int opRc;
+
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT; ++i)
+  {
+    opRc = gpioPortDisablePinIrq(&wakeupSources[i]->dev);
+    if(rc == 0)
+      rc = opRc;
+  }
+
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+  {
+    opRc = zephyrGpioClear(columns + i);
+    if(rc == 0)
+      rc = opRc;
+  }
+
+  return rc;
+}
+
+/**
+ * @brief   Read the idle mode wake-up sources, the columns being driven.
+ *
+ * @param active  The active wake-up source flag.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int readWakeupSources(bool *active)
+{
+  int rc = 0;
+
+  *active = false;
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT && rc >= 0 && !*active;
+      ++i)
+  {
+    rc = zephyrGpioRead(wakeupSources[i]);
+    *active = rc == GPIO_SET;
+  }
+
+  return rc < 0 ? rc : 0;
+}
+
+/**
+ * @brief   Drive all the columns and arm the idle mode wake-up interrupts.
+ *          The wake-up semaphore is given right away if an input is already
+ *          active once the interrupts are armed.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int enterIdleMode(void)
+{
+  int rc = 0;
+  bool active = false;
+
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT && rc == 0; ++i)
+    rc = zephyrGpioSet(columns + i);
+
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT && rc == 0; ++i)
+    rc = zephyrGpioEnableIrq(wakeupSources[i], GPIO_IRQ_EDGE_BOTH);
+
+  /* catch a press that happened before the interrupts were armed */
+  if(rc == 0)
+    rc = readWakeupSources(&active);
+
+  if(rc < 0)
+  {
+    exitIdleMode();
+    return rc;
+  }
+
+  if(active)
+    k_sem_give(&wakeupSem);
+
+  return 0;
+}
+
+/**
+ * @brief   Wait for a wake-up interrupt in the idle mode. If the interrupts
+ *          cannot be armed, the idle mode is disabled for good and the
+ *          button thread keeps scanning.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int waitForIdleWakeup(void)
+{
+  int rc;
+
+  rc = enterIdleMode();
+  if(rc < 0)
+  {
+    LOG_WRN("unable to arm the wake-up interrupts, idle mode disabled");
+    wakeupIrqAvailable = false;
+    return rc;
+  }
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+  /* the hardware decoded encoders cannot wake the thread up, poll them */
+  while(k_sem_take(&wakeupSem, K_MSEC(CONFIG_BUTTON_MNGR_QDEC_IDLE_POLL_MS)) ==
+        -EAGAIN && !readQdecEncoders())
+    ;
+#else
+  k_sem_take(&wakeupSem, K_FOREVER);
+#endif
+
+  return exitIdleMode();
+}
+
+/**
+ * @brief   Enter the idle mode until a wake-up source is active or an
+ *          encoder steps.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int waitForWakeup(void)
+{
+  int rc;
+
+  /* reset before the idle flag is set, so that no step wake-up is lost */
+  k_sem_reset(&wakeupSem);
+  atomic_set(&idleFlag, 1);
+
+  rc = waitForIdleWakeup();
+
+  atomic_clear(&idleFlag);
+
+  return rc;
+}
+
+/**
+ * @brief   Check if an idle mode wake-up source shares its EXTI line with an
+ *          earlier wake-up source or with an encoder using its IRQs. The EXTI
+ *          lines are shared by pin number across the GPIO ports.
+ *
+ * @param src   The wake-up source index.
+ *
+ * @return  true if the EXTI line is shared, false otherwise.
+ */
+static bool isWakeupLineShared(uint8_t src)
+{
+  const struct gpio_dt_spec *spec = &wakeupSources[src]->dev;
+
+  for(uint8_t i = 0; i < src; ++i)
+  {
+    if(wakeupSources[i]->dev.pin == spec->pin &&
+       wakeupSources[i]->dev.port != spec->port)
+      return true;
+  }
+
+  for(const EncoderDesc *enc = encoders; enc < encoders + ENCODER_COUNT; ++enc)
+  {
+    if(!isEncoderIrqDriven(enc))
+      continue;
+
+    if(enc->signals[0].dev.pin == spec->pin ||
+       enc->signals[1].dev.pin == spec->pin)
+      return true;
+  }
+
+  return false;
+}
+
+/**
+ * @brief   Initialize the idle mode wake-up sources. Each source sharing an
+ *          EXTI line is reported and the wake-up interrupts are left
+ *          unavailable if any source shares its line or if any wake-up
+ *          callback cannot be added. The idle mode is then disabled.
+ */
+static void initWakeupSources(void)
+{
+  int rc = 0;
+  uint8_t src = 0;
+  bool shared = false;
+
+  for(uint8_t i = 0; i < BUTTON_ROW_COUNT; ++i)
+    wakeupSources[src++] = rows + i;
+
+  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT; ++i)
+    wakeupSources[src++] = shifters + i;
+
+  for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT; ++i)
+    wakeupSources[src++] = rockers + i;
+
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT; ++i)
+  {
+    if(isWakeupLineShared(i))
+    {
+      LOG_WRN("wake-up source %u shares EXTI line %u", i,
+              wakeupSources[i]->dev.pin);
+      shared = true;
+    }
+  }
+
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT && rc == 0 && !shared;
+      ++i)
+    rc = zephyrGpioAddIrqCallback(wakeupSources[i], wakeupIrq);
+
+  wakeupIrqAvailable = !shared && rc == 0;
+  if(!wakeupIrqAvailable)
+    LOG_WRN("wake-up interrupts unavailable, idle mode disabled");
+}
+#endif
+
+/**
+ * @brief   Update the scan statistics with the period since the last scan.
+ *
+ * @param now   The cycle count of the current scan.
+ */
+static void updateScanStats(uint32_t now)
+{
+  uint32_t periodUs;
+  uint32_t jitterUs;
+  k_spinlock_key_t key;
+
+  key = k_spin_lock(&scanStatsLock);
+
+  if(!scanStatsRestart)
+  {
+    periodUs = k_cyc_to_us_near32(now - lastScanCycle);
+    jitterUs = periodUs > scanStats.periodUs ? periodUs - scanStats.periodUs :
+      scanStats.periodUs - periodUs;
+
+    ++scanStats.scanCount;
+    scanStats.minPeriodUs = MIN(scanStats.minPeriodUs, periodUs);
+    scanStats.maxPeriodUs = MAX(scanStats.maxPeriodUs, periodUs);
+    scanStats.maxJitterUs = MAX(scanStats.maxJitterUs, jitterUs);
+  }
+
+  lastScanCycle = now;
+  scanStatsRestart = false;
+
+  k_spin_unlock(&scanStatsLock, key);
+}
+
+/**
+ * @brief   Start the scan timer. The first scan is triggered right away.
+ */
+static void startScanTimer(void)
+{
+  k_spinlock_key_t key;
+
+  key = k_spin_lock(&scanStatsLock);
+  scanStatsRestart = true;
+  k_spin_unlock(&scanStatsLock, key);
+
+  k_sem_reset(&scanSem);
+  k_timer_start(&scanTimer, K_NO_WAIT, K_USEC(BUTTON_MNGR_SCAN_PERIOD_US));
+}
 
-  state = processEncoderIrq(mapEncoder, encSigStates + MAP_ENC_IDX);
+/**
+ * @brief The debounced matrix states of the last scan, kept on read errors.
+*/
+static uint32_t matrixStates = 0;
 
-  if(state == ENCODER_INCREMENT)
-    buttonStates[MAP_INC_IDX] = BUTTON_PRESSED;
-  else if(state == ENCODER_DECREMENT)
-    buttonStates[MAP_DEC_IDX] = BUTTON_PRESSED;
+/**
+ * @brief The debounced shifter states of the last scan, kept on read errors.
+*/
+static uint32_t shifterStates = 0;
+
+/**
+ * @brief The debounced rocker states of the last scan, kept on read errors.
+*/
+static uint32_t rockerStates = 0;
+
+/**
+ * @brief   Check if any of the matrix, shifter or rocker button is pressed.
+ *
+ * @return  true if a button is pressed, false otherwise.
+ */
+static bool isAnyButtonPressed(void)
+{
+  return atomic_get(&inputBits) != 0;
 }
 
 /**
- * @brief   Read the button matrix.
+ * @brief   Scan all the buttons, publish their states and notify the
+ *          subscribers of the changes.
  *
- * @return  0 if successful, the error code otherwise.
+ * @param scanCycle   The scan cycle counter value.
+ *
+ * @return  true if a button is pressed or an encoder moved, false otherwise.
  */
-static int readButtonMatrix(void)
+static bool scanButtons(uint32_t scanCycle)
 {
   int rc;
-  int buttonState = 0;
-  bool keepReading = true;
+  bool encMoved;
+  bool qdecMoved = false;
 
-  for(uint8_t col = 0; col < BUTTON_COL_COUNT && keepReading; ++col)
+  if(atomic_cas(&settleCalibRequest, 1, 0))
   {
-    /* set the column to read */
-    rc = zephyrGpioSet(columns + col);
-    if(rc < 0)
-      return rc;
+    settleCalibRc = calibrateSettleTime();
+    k_sem_give(&settleCalibSem);
+  }
 
-    for(uint8_t row = 0; row < BUTTON_ROW_COUNT && buttonState >= 0; ++row)
-    {
-      buttonState = zephyrGpioRead(rows + row);
-      if(buttonState < 0)
-        keepReading = false;
-      else
-        buttonStates[BUTTON_ROW_COUNT * col + row] =
-          (WheelButtonState)buttonState;
-    }
+  rc = readButtonMatrix(&matrixStates);
+  if(rc < 0)
+    LOG_ERR("unable to read button matrix");
 
-    /* clear the column read */
-    rc = zephyrGpioClear(columns + col);
-    if(rc < 0)
-      keepReading = false;
-  }
+  rc = readButtonShifters(&shifterStates);
+  if(rc < 0)
+    LOG_ERR("unable to read shifters");
 
-  if(buttonState < 0)
-    rc = buttonState;
+  rc = readButtonRockers(&rockerStates);
+  if(rc < 0)
+    LOG_ERR("unable to read rockers");
 
-  return rc;
+  stampRawEdges(scanCycle);
+  publishInputStates(matrixStates, shifterStates, rockerStates);
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+  qdecMoved = readQdecEncoders();
+#endif
+
+  notifySubscribers(scanCycle);
+
+  /* the encoder steps of the IRQs and the poll timer count as activity */
+  encMoved = atomic_clear(&encActivity) != 0;
+
+  return isAnyButtonPressed() || encMoved || qdecMoved;
 }
 
 /**
- * @brief   Read the shifter buttons.
+ * @brief   The button manager thread implementation.
  *
- * @return  0 if successful, the error code otherwise.
+ * @param p1  The first parameter.
+ * @param p2  The second parameter.
+ * @param p3  The third parameter.
  */
-static int readButtonShifters(void)
+static void buttonMngrThread(void *p1, void *p2, void *p3)
 {
-  int rc = 0;
+  __maybe_unused int rc;
+  uint32_t scanCycle;
+  __maybe_unused bool active;
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+  uint32_t lastActivity = k_uptime_get_32();
+#endif
 
-  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT && rc >= 0; ++i)
+  startScanTimer();
+
+  for(;;)
   {
-    rc = zephyrGpioRead(shifters + i);
-    if(rc >= 0)
-      buttonStates[LEFT_SHIFTER_IDX + i] = (WheelButtonState)rc;
+    k_sem_take(&scanSem, K_FOREVER);
+    scanCycle = k_cycle_get_32();
+    updateScanStats(scanCycle);
+
+    active = scanButtons(scanCycle);
+
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+    if(active)
+      lastActivity = k_uptime_get_32();
+    else if(wakeupIrqAvailable && k_uptime_get_32() - lastActivity >=
+            CONFIG_BUTTON_MNGR_IDLE_TIMEOUT_MS)
+    {
+      k_timer_stop(&scanTimer);
+
+      rc = waitForWakeup();
+      if(rc < 0)
+        LOG_ERR("idle mode failure");
+
+      lastActivity = k_uptime_get_32();
+      startScanTimer();
+    }
+#endif
   }
+}
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+BUILD_ASSERT(CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_RATE >
+             CONFIG_BUTTON_MNGR_ENC_ACCEL_MIN_RATE,
+             "the full acceleration rate must be above the start rate");
+
+/**
+ * @brief   Get the acceleration factor of a step rate. The factor rises
+ *          linearly from 1 at the minimal rate to the maximal factor at the
+ *          maximal rate.
+ *
+ * @param rate    The step rate [steps/s].
+ *
+ * @return  The acceleration factor.
+ */
+static uint32_t getAccelFactor(uint32_t rate)
+{
+  if(rate <= CONFIG_BUTTON_MNGR_ENC_ACCEL_MIN_RATE)
+    return 1;
+
+  if(rate >= CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_RATE)
+    return CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_FACTOR;
 
-   return rc;
+  return 1 + (CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_FACTOR - 1) *
+    (rate - CONFIG_BUTTON_MNGR_ENC_ACCEL_MIN_RATE) /
+    (CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_RATE -
+     CONFIG_BUTTON_MNGR_ENC_ACCEL_MIN_RATE);
 }
 
 /**
- * @brief   Read the rocker buttons.
+ * @brief   Accelerate the steps read from an encoder. The step rate is taken
+ *          from the period between the last two steps, so the time since
+ *          the previous read, or a pause before a flick, does not slow it
+ *          down.
  *
- * @return  0 if successful, the error code otherwise.
+ * @param enc     The encoder descriptor.
+ * @param steps   The read steps.
+ *
+ * @return  The accelerated steps.
  */
-static int readButtonRockers(void)
+static int32_t accelerateSteps(EncoderDesc *enc, int32_t steps)
 {
-  int rc = 0;
+  uint32_t periodUs;
+  uint32_t rate;
 
-  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT && rc >= 0; ++i)
-  {
-    rc = zephyrGpioRead(rockers + i);
-    if(rc >= 0)
-      buttonStates[LEFT_ROCKER_IDX + i] = (WheelButtonState)rc;
-  }
+  if(steps == 0)
+    return 0;
+
+  periodUs = k_cyc_to_us_near32(enc->stepPeriod);
+  rate = periodUs > 0 ? USEC_PER_SEC / periodUs : UINT32_MAX;
 
-   return rc;
+  return steps * (int32_t)getAccelFactor(rate);
 }
+#endif
 
 /**
- * @brief   The button manager thread implementation.
+ * @brief   Initialize the matrix, shifter and rocker debouncers.
  *
- * @param p1  The first parameter.
- * @param p2  The second parameter.
- * @param p3  The third parameter.
+ * @return  0 if successful, the error code otherwise.
  */
-static void buttonMngrThread(void *p1, void *p2, void *p3)
+static int initDebouncers(void)
 {
   int rc;
 
-  for(;;)
-  {
-    rc = readButtonMatrix();
-    if(rc < 0)
-      LOG_ERR("unable to read button matrix");
-
-    rc = readButtonShifters();
-    if(rc < 0)
-      LOG_ERR("unable to read shifters");
+  rc = debounceInit(&matrixDebouncer,
+    (DebounceAlgo)CONFIG_BUTTON_MNGR_MATRIX_DEBOUNCE_ALGO,
+    BUTTON_MNGR_MATRIX_KEY_CNT,
+    BUTTON_MNGR_DEBOUNCE_SAMPLES(CONFIG_BUTTON_MNGR_MATRIX_DEBOUNCE_TIME_MS));
+  if(rc < 0)
+    return rc;
 
-    rc = readButtonRockers();
-    if(rc < 0)
-      LOG_ERR("unable to read rockers");
+  rc = debounceInit(&shifterDebouncer,
+    (DebounceAlgo)CONFIG_BUTTON_MNGR_SHIFTER_DEBOUNCE_ALGO,
+    BUTTON_SHIFTER_COUNT,
+    BUTTON_MNGR_DEBOUNCE_SAMPLES(CONFIG_BUTTON_MNGR_SHIFTER_DEBOUNCE_TIME_MS));
+  if(rc < 0)
+    return rc;
 
-    zephyrThreadSleepMs(100);
-  }
+  return debounceInit(&rockerDebouncer,
+    (DebounceAlgo)CONFIG_BUTTON_MNGR_ROCKER_DEBOUNCE_ALGO,
+    BUTTON_ROCKER_COUNT,
+    BUTTON_MNGR_DEBOUNCE_SAMPLES(CONFIG_BUTTON_MNGR_ROCKER_DEBOUNCE_TIME_MS));
 }
 
 /**
@@ -500,6 +1944,164 @@ static int initEncoderGpio(ZephyrGpio *encGpio, ZephyrGpioIrqCb callback)
   return rc;
 }
 
+/**
+ * @brief   Check if both encoder signals are mapped on the same pin, which
+ *          cannot be decoded.
+ *
+ * @param enc   The encoder descriptor.
+ *
+ * @return  true if the signals are on the same pin, false otherwise.
+ */
+static bool isEncoderPinDuplicated(const EncoderDesc *enc)
+{
+  return enc->signals[0].dev.port == enc->signals[1].dev.port &&
+         enc->signals[0].dev.pin == enc->signals[1].dev.pin;
+}
+
+/**
+ * @brief   Check if an encoder signal shares its EXTI line with its other
+ *          signal or with an encoder initialized before it. The EXTI lines
+ *          are shared by pin number across the GPIO ports.
+ *
+ * @param enc   The encoder descriptor.
+ *
+ * @return  true if an EXTI line is shared, false otherwise.
+ */
+static bool isEncoderLineShared(const EncoderDesc *enc)
+{
+  if(enc->signals[0].dev.pin == enc->signals[1].dev.pin)
+    return true;
+
+  for(const EncoderDesc *other = encoders; other < enc; ++other)
+  {
+    if(!isEncoderIrqDriven(other))
+      continue;
+
+    for(uint8_t sig = 0; sig < BUTTON_MNGR_ENC_SIG_CNT; ++sig)
+    {
+      if(enc->signals[sig].dev.pin == other->signals[0].dev.pin ||
+         enc->signals[sig].dev.pin == other->signals[1].dev.pin)
+        return true;
+    }
+  }
+
+  return false;
+}
+
+/**
+ * @brief   List the ports of the polled encoder signals and store the port
+ *          index of each signal.
+ */
+static void initEncoderPollPorts(void)
+{
+  uint8_t port;
+
+  encPollPortCount = 0;
+  for(EncoderDesc *enc = encoders; enc < encoders + ENCODER_COUNT; ++enc)
+  {
+    for(uint8_t sig = 0; sig < BUTTON_MNGR_ENC_SIG_CNT && enc->polled; ++sig)
+    {
+      port = 0;
+      while(port < encPollPortCount &&
+            encPollPorts[port] != enc->signals[sig].dev.port)
+        ++port;
+
+      if(port == encPollPortCount)
+        encPollPorts[encPollPortCount++] = enc->signals[sig].dev.port;
+
+      enc->pollPorts[sig] = port;
+    }
+  }
+}
+
+/**
+ * @brief   Start the encoder poll timer if any encoder is polled and report
+ *          the polled encoders.
+ */
+static void startEncoderPolling(void)
+{
+  bool anyPolled = false;
+
+  initEncoderPollPorts();
+
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
+  {
+    if(encoders[i].polled && !IS_ENABLED(CONFIG_BUTTON_MNGR_ENC_POLL_ALL))
+      LOG_WRN("encoder %u has no EXTI line of its own, polled at %u Hz", i,
+              CONFIG_BUTTON_MNGR_ENC_POLL_RATE_HZ);
+
+    anyPolled = anyPolled || encoders[i].polled;
+  }
+
+  if(IS_ENABLED(CONFIG_BUTTON_MNGR_ENC_POLL_ALL))
+    LOG_INF("encoders polled at %u Hz", CONFIG_BUTTON_MNGR_ENC_POLL_RATE_HZ);
+
+  if(anyPolled)
+    k_timer_start(&encoderPollTimer, K_USEC(BUTTON_MNGR_ENC_POLL_PERIOD_US),
+                  K_USEC(BUTTON_MNGR_ENC_POLL_PERIOD_US));
+}
+
+/**
+ * @brief   Initialize an encoder, either its hardware decoder if it has one or
+ *          its signal GPIOs. The signals are polled if they cannot get EXTI
+ *          lines of their own. The encoder is left disabled if both signals
+ *          are on the same pin.
+ *
+ * @param enc   The encoder descriptor.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int initEncoder(EncoderDesc *enc)
+{
+  int rc = 0;
+  int sigA;
+  int sigB;
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+  if(enc->qdec.dev)
+    return encoderQdecInit(&enc->qdec);
+#endif
+
+  enc->polled = false;
+  enc->disabled = isEncoderPinDuplicated(enc);
+  if(enc->disabled)
+  {
+    LOG_ERR("encoder %d signals A and B on the same pin, check the devicetree",
+            (int)(enc - encoders));
+    return 0;
+  }
+
+  enc->polled = IS_ENABLED(CONFIG_BUTTON_MNGR_ENC_POLL_ALL) ||
+    isEncoderLineShared(enc);
+
+  for(uint8_t sig = 0; sig < BUTTON_MNGR_ENC_SIG_CNT && rc == 0 &&
+      !enc->polled; ++sig)
+    rc = initEncoderGpio(enc->signals + sig, encoderIrq);
+
+  /* the EXTI line is already taken by another driver */
+  if(rc == -EBUSY)
+  {
+    for(uint8_t sig = 0; sig < BUTTON_MNGR_ENC_SIG_CNT; ++sig)
+      gpioPortDisablePinIrq(&enc->signals[sig].dev);
+
+    enc->polled = true;
+    rc = 0;
+  }
+
+  for(uint8_t sig = 0; sig < BUTTON_MNGR_ENC_SIG_CNT && rc == 0 &&
+      enc->polled; ++sig)
+    rc = zephyrGpioInit(enc->signals + sig, GPIO_IN);
+
+  /* start from the current signals, not from a false transition */
+  if(rc == 0)
+    rc = readEncoderSignals(enc, &sigA, &sigB);
+
+  if(rc == 0)
+    enc->state = (((sigA << 1) | sigB) << 2) | (sigA << 1) | sigB;
+
+  return rc;
+}
+
 int buttonMngrInit(void)
 {
   int rc = 0;
@@ -510,29 +2112,32 @@ int buttonMngrInit(void)
   for(uint8_t i = 0; i < BUTTON_COL_COUNT && rc == 0; ++i)
     rc = zephyrGpioInit(columns + i, GPIO_OUT_CLR);
 
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
+  if(rc == 0)
+    initMatrixPortGroups();
+#endif
+
   for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT && rc == 0; ++i)
     rc = zephyrGpioInit(shifters + i, GPIO_IN);
 
   for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT && rc == 0; ++i)
     rc = zephyrGpioInit(rockers + i, GPIO_IN);
 
-  for(uint8_t i = 0; i < BUTTON_MNGR_ENC_SIG_CNT && rc == 0; ++i)
-    rc = initEncoderGpio(leftEncoder + i, leftEncoderIrq);
-
-  for(uint8_t i = 0; i < BUTTON_MNGR_ENC_SIG_CNT && rc == 0; ++i)
-    rc = initEncoderGpio(rightEncoder + i, rightEncoderIrq);
+  for(uint8_t i = 0; i < ENCODER_COUNT && rc == 0; ++i)
+    rc = initEncoder(encoders + i);
 
-  for(uint8_t i = 0; i < BUTTON_MNGR_ENC_SIG_CNT && rc == 0; ++i)
-    rc = initEncoderGpio(tcEncoder + i, tcEncoderIrq);
+  if(rc == 0)
+    startEncoderPolling();
 
-  for(uint8_t i = 0; i < BUTTON_MNGR_ENC_SIG_CNT && rc == 0; ++i)
-    rc = initEncoderGpio(tc1Encoder + i, tc1EncoderIrq);
+  if(rc == 0)
+    rc = initDebouncers();
 
-  for(uint8_t i = 0; i < BUTTON_MNGR_ENC_SIG_CNT && rc == 0; ++i)
-    rc = initEncoderGpio(absEncoder + i, absEncoderIrq);
+  settleCycles = BUTTON_MNGR_SETTLE_MAX_CYCLES;
 
-  for(uint8_t i = 0; i < BUTTON_MNGR_ENC_SIG_CNT && rc == 0; ++i)
-    rc = initEncoderGpio(mapEncoder + i, mapEncoderIrq);
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+  if(rc == 0)
+    initWakeupSources();
+#endif
 
   if(rc == 0)
   {
@@ -549,15 +2154,154 @@ int buttonMngrInit(void)
 
 int buttonMngrGetAllStates(WheelButtonState *states, size_t count)
 {
+  WheelButtonBits bits;
+
   if(count != BUTTON_COUNT)
     return -EINVAL;
 
-  bytecpy(states, buttonStates, count * sizeof(WheelButtonState));
+  bits = buttonMngrGetSnapshot();
+  for(uint8_t i = 0; i < BUTTON_COUNT; ++i)
+    states[i] = (WheelButtonState)((bits >> i) & 1);
+
+  return 0;
+}
+
+WheelButtonBits buttonMngrGetSnapshot(void)
+{
+  uint32_t inputs;
+  uint32_t encoders;
+
+  /* read and clear the encoder buttons in one exchange so that a press
+   * set by an encoder IRQ is either returned now or kept for the next call */
+  inputs = (uint32_t)atomic_get(&inputBits);
+  encoders = (uint32_t)atomic_clear(&encoderBits);
+
+  return (WheelButtonBits)inputs | ((WheelButtonBits)encoders << TC_INC_IDX);
+}
+
+int buttonMngrSubscribe(struct k_msgq *queue)
+{
+  int rc = 0;
+  k_spinlock_key_t key;
+
+  if(!queue || queue->msg_size != sizeof(ButtonMngrEvent))
+    return -EINVAL;
+
+  key = k_spin_lock(&subscriberLock);
+
+  if(atomic_get(&subscriberCount) < CONFIG_BUTTON_MNGR_SUBSCRIBER_COUNT)
+  {
+    subscribers[atomic_get(&subscriberCount)] = queue;
+    atomic_inc(&subscriberCount);
+  }
+  else
+    rc = -ENOMEM;
+
+  k_spin_unlock(&subscriberLock, key);
+
+  return rc;
+}
+
+int buttonMngrGetEdgeCycle(WheelButtonIdx idx, uint32_t *cycle)
+{
+  if(idx >= BUTTON_COUNT)
+    return -EINVAL;
+
+  if(!atomic_test_bit(edgeValid, idx))
+    return -ENODATA;
+
+  *cycle = edgeCycles[idx];
+
+  return 0;
+}
+
+void buttonMngrInitCursor(ButtonMngrCursor *cursor)
+{
+  /* start from the current presses so that past presses are not reported */
+  readEncoderPresses(cursor);
+}
+
+WheelButtonBits buttonMngrReadCursor(ButtonMngrCursor *cursor)
+{
+  uint32_t inputs;
+  uint32_t encoders;
+
+  inputs = (uint32_t)atomic_get(&inputBits);
+  encoders = readEncoderPresses(cursor);
+
+  return (WheelButtonBits)inputs | ((WheelButtonBits)encoders << TC_INC_IDX);
+}
+
+int buttonMngrGetEncoderSteps(WheelEncoderIdx enc, int32_t *steps)
+{
+  if(enc >= ENCODER_COUNT)
+    return -EINVAL;
+
+  *steps = (int32_t)atomic_clear(encSteps + enc);
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+  if(CONFIG_BUTTON_MNGR_ENC_ACCEL_ENCODERS & BIT(enc))
+    *steps = accelerateSteps(encoders + enc, *steps);
+#endif
+
+  return 0;
+}
+
+int buttonMngrGetEncoderNoise(WheelEncoderIdx enc, uint32_t *count)
+{
+  if(enc >= ENCODER_COUNT)
+    return -EINVAL;
 
-  for(uint8_t i = TC_INC_IDX; i < BUTTON_COUNT; ++i)
-    buttonStates[i] = BUTTON_DEPRESSED;
+  *count = (uint32_t)atomic_get(encNoise + enc);
 
   return 0;
 }
 
+uint32_t buttonMngrGetSettleTime(void)
+{
+  return k_cyc_to_ns_near32(settleCycles);
+}
+
+int buttonMngrCalibrateSettleTime(void)
+{
+  k_sem_reset(&settleCalibSem);
+  atomic_set(&settleCalibRequest, 1);
+
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+  /* the button thread only scans once woken up */
+  k_sem_give(&wakeupSem);
+#endif
+
+  if(k_sem_take(&settleCalibSem, BUTTON_MNGR_SETTLE_CALIB_TIMEOUT) < 0)
+  {
+    atomic_clear(&settleCalibRequest);
+    return -EAGAIN;
+  }
+
+  return settleCalibRc;
+}
+
+void buttonMngrGetScanStats(ButtonMngrScanStats *stats)
+{
+  k_spinlock_key_t key;
+
+  key = k_spin_lock(&scanStatsLock);
+  *stats = scanStats;
+  k_spin_unlock(&scanStatsLock, key);
+}
+
+void buttonMngrResetScanStats(void)
+{
+  k_spinlock_key_t key;
+
+  key = k_spin_lock(&scanStatsLock);
+  scanStats.scanCount = 0;
+  scanStats.minPeriodUs = UINT32_MAX;
+  scanStats.maxPeriodUs = 0;
+  scanStats.maxJitterUs = 0;
+  scanStats.ghostCount = 0;
+  scanStatsRestart = true;
+  k_spin_unlock(&scanStatsLock, key);
+}
+
 /** @} */
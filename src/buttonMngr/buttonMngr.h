@@ -16,15 +16,27 @@
 #ifndef BUTTON_MNGR
 #define BUTTON_MNGR
 
+#include <zephyr/devicetree.h>
+#include <zephyr/sys/util.h>
+
+/**
+ * @brief The button matrix devicetree node.
+*/
+#define BUTTON_MATRIX_NODE      DT_INST(0, enya_button_matrix)
+
+#if !DT_NODE_HAS_STATUS(BUTTON_MATRIX_NODE, okay)
+#error "an enabled enya,button-matrix node is required"
+#endif
+
 /**
  * @brief The button row count.
 */
-#define BUTTON_ROW_COUNT        8
+#define BUTTON_ROW_COUNT        DT_PROP_LEN(BUTTON_MATRIX_NODE, rows)
 
 /**
  * @brief The button column count.
 */
-#define BUTTON_COL_COUNT        4
+#define BUTTON_COL_COUNT        DT_PROP_LEN(BUTTON_MATRIX_NODE, columns)
 
 /**
  * @brief The shifter button count.
@@ -37,47 +49,17 @@
 #define BUTTON_ROCKER_COUNT     2
 
 /**
- * @brief The button index x(button name, button column, button row).
+ * @brief Declare the index of a button matrix key from its name in the
+ *        key-names property of the matrix node, e.g. "left_shifter" gives
+ *        LEFT_SHIFTER_IDX, the key index being column * row count + row.
 */
-#define LIST_BUTTON_IDX   X(TC_ENC_BTN_IDX,       0, 0)     \
-                          X(TC1_ENC_BTN_IDX,      0, 1)     \
-                          X(ABS_ENC_BTN_IDX,      0, 2)     \
-                          X(MAP_ENC_BTN_IDX,      0, 3)     \
-                          X(LEFT_TOP_0_IDX,       0, 4)     \
-                          X(LEFT_TOP_1_IDX,       0, 5)     \
-                          X(LEFT_TOP_2_IDX,       0, 6)     \
-                          X(LEFT_ENC_BTN_IDX,     0, 7)     \
-                          X(RIGHT_TOP_0_IDX,      1, 0)     \
-                          X(RIGHT_TOP_1_IDX,      1, 1)     \
-                          X(RIGHT_TOP_2_IDX,      1, 2)     \
-                          X(RIGHT_ENC_BTN_IDX,    1, 3)     \
-                          X(LEFT_SHIFTER_IDX,     1, 4)     \
-                          X(RIGHT_SHIFTER_IDX,    1, 5)     \
-                          X(LEFT_ROCKER_IDX,      1, 6)     \
-                          X(RIGHT_ROCKER_IDX,     1, 7)     \
-                          X(LEFT_SIDE_0_IDX,      2, 0)     \
-                          X(LEFT_SIDE_1_IDX,      2, 1)     \
-                          X(LEFT_SIDE_SEL_IDX,    2, 2)     \
-                          X(LEFT_SIDE_UP_IDX,     2, 3)     \
-                          X(LEFT_SIDE_LEFT_IDX,   2, 4)     \
-                          X(LEFT_SIDE_DOWN_IDX,   2, 5)     \
-                          X(LEFT_SIDE_RIGHT_IDX,  2, 6)     \
-                          X(LEFT_SIDE_2_IDX,      2, 7)     \
-                          X(RIGHT_SIDE_0_IDX,     3, 0)     \
-                          X(RIGHT_SIDE_1_IDX,     3, 1)     \
-                          X(RIGHT_SIDE_SEL_IDX,   3, 2)     \
-                          X(RIGHT_SIDE_UP_IDX,    3, 3)     \
-                          X(RIGHT_SIDE_LEFT_IDX,  3, 4)     \
-                          X(RIGHT_SIDE_DOWN_IDX,  3, 5)     \
-                          X(RIGHT_SIDE_RIGHT_IDX, 3, 6)     \
-                          X(RIGHT_SIDE_2_IDX,     3, 7)
+#define BUTTON_MATRIX_KEY_IDX(node, prop, idx)                               \
+  UTIL_CAT(DT_STRING_UPPER_TOKEN_BY_IDX(node, prop, idx), _IDX) = idx,
 
 typedef enum
 {
-#define X(name, col, row) name = col * BUTTON_ROW_COUNT + row,
-  LIST_BUTTON_IDX
-#undef X
-  TC_INC_IDX,
+  DT_FOREACH_PROP_ELEM(BUTTON_MATRIX_NODE, key_names, BUTTON_MATRIX_KEY_IDX)
+  TC_INC_IDX = BUTTON_ROW_COUNT * BUTTON_COL_COUNT,
   TC_DEC_IDX,
   TC1_INC_IDX,
   TC1_DEC_IDX,
@@ -96,6 +78,16 @@ typedef enum
   BUTTON_COUNT,
 } WheelButtonIdx;
 
+/**
+ * @brief The encoder button count.
+*/
+#define BUTTON_ENC_BUTTON_COUNT (BUTTON_COUNT - TC_INC_IDX)
+
+/**
+ * @brief The maximal edge count of a change event.
+*/
+#define BUTTON_MNGR_EVENT_EDGE_MAX  4
+
 /**
  * @brief The button state.
 */
@@ -105,6 +97,74 @@ typedef enum
   BUTTON_PRESSED,                         /**< The button pressed state. */
 } WheelButtonState;
 
+/**
+ * @brief The encoder indexes.
+*/
+typedef enum
+{
+  LEFT_ENC_IDX = 0,                       /**< The left encoder index. */
+  RIGHT_ENC_IDX,                          /**< The right encoder index. */
+  TC_ENC_IDX,                             /**< The TC encoder index. */
+  TC1_ENC_IDX,                            /**< The TC1 encoder index. */
+  ABS_ENC_IDX,                            /**< The ABS encoder index. */
+  MAP_ENC_IDX,                            /**< The MAP encoder index. */
+  ENCODER_COUNT,                          /**< The total encoder count. */
+} WheelEncoderIdx;
+
+/**
+ * @brief The packed button states, bit n being the state of the button n.
+*/
+typedef uint64_t WheelButtonBits;
+
+/**
+ * @brief The consumer read cursor on the encoder buttons. Each consumer owns
+ *        its cursor and sees every encoder press once, whatever the other
+ *        consumers read.
+*/
+typedef struct
+{
+  uint32_t pressCounts[BUTTON_ENC_BUTTON_COUNT];  /**< The press counts seen by the consumer. */
+} ButtonMngrCursor;
+
+/**
+ * @brief The button edge of a change event.
+*/
+typedef struct
+{
+  WheelButtonIdx idx;                     /**< The button index. */
+  uint32_t cycle;                         /**< The cycle counter value of the edge. */
+} ButtonMngrEdge;
+
+/**
+ * @brief The button change event, posted to the subscribers at the end of
+ *        every scan that changed a button. The encoder buttons are reported
+ *        pressed in the event following their steps, never released. The
+ *        edges of the first BUTTON_MNGR_EVENT_EDGE_MAX changed buttons, by
+ *        index, are listed, the others can be read with
+ *        buttonMngrGetEdgeCycle().
+*/
+typedef struct
+{
+  WheelButtonBits changed;                /**< The changed buttons. */
+  WheelButtonBits states;                 /**< The new button states. */
+  uint32_t cycle;                         /**< The cycle counter value of the scan. */
+  uint8_t edgeCount;                      /**< The listed edge count. */
+  ButtonMngrEdge edges[BUTTON_MNGR_EVENT_EDGE_MAX]; /**< The changed button edges. */
+} ButtonMngrEvent;
+
+/**
+ * @brief The button scan statistics.
+*/
+typedef struct
+{
+  uint32_t scanCount;                     /**< The measured scan count. */
+  uint32_t periodUs;                      /**< The nominal scan period [us]. */
+  uint32_t minPeriodUs;                   /**< The minimal scan period [us]. */
+  uint32_t maxPeriodUs;                   /**< The maximal scan period [us]. */
+  uint32_t maxJitterUs;                   /**< The maximal deviation from the nominal period [us]. */
+  uint32_t ghostCount;                    /**< The scans with a ghosting key rectangle. */
+} ButtonMngrScanStats;
+
 /**
  * @brief   Initialize the button manager.
  *
@@ -113,7 +173,9 @@ typedef enum
 int buttonMngrInit(void);
 
 /**
- * @brief   Get all the current button states.
+ * @brief   Get all the current button states. The encoder buttons are
+ *          cleared once read (see buttonMngrGetSnapshot), use a cursor for
+ *          an independent consumer.
  *
  * @param states  All the current button states.
  * @param count   The count of button states to get.
@@ -122,6 +184,114 @@ int buttonMngrInit(void);
  */
 int buttonMngrGetAllStates(WheelButtonState *states, size_t count);
 
+/**
+ * @brief   Get a snapshot of all the button states packed in a single word.
+ *          The encoder buttons are read and cleared in one atomic exchange,
+ *          so a press set by an encoder IRQ is never lost between two calls.
+ *          The encoder buttons are shared by all the callers, use a cursor
+ *          for an independent consumer.
+ *
+ * @return  The packed button states.
+ */
+WheelButtonBits buttonMngrGetSnapshot(void);
+
+/**
+ * @brief   Initialize a consumer cursor. The encoder presses that happened
+ *          before are not reported.
+ *
+ * @param cursor  The consumer cursor.
+ */
+void buttonMngrInitCursor(ButtonMngrCursor *cursor);
+
+/**
+ * @brief   Get all the button states packed in a single word, the encoder
+ *          buttons being the ones pressed since the last read of the cursor.
+ *          The cursor must only be used by its consumer, other consumers
+ *          are not affected.
+ *
+ * @param cursor  The consumer cursor.
+ *
+ * @return  The packed button states.
+ */
+WheelButtonBits buttonMngrReadCursor(ButtonMngrCursor *cursor);
+
+/**
+ * @brief   Subscribe a message queue to the button change events. The queue
+ *          message size must be sizeof(ButtonMngrEvent). The events are
+ *          posted without waiting, a full queue misses them.
+ *
+ * @param queue   The message queue.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int buttonMngrSubscribe(struct k_msgq *queue);
+
+/**
+ * @brief   Get the cycle counter value of the last edge of a button. The
+ *          matrix, shifter and rocker edges are stamped at the scan that
+ *          first saw the raw level they debounced to, the encoder buttons in
+ *          their IRQ.
+ *
+ * @param idx     The button index.
+ * @param cycle   The edge cycle counter value.
+ *
+ * @return  0 if successful, -ENODATA if the button never changed, the error
+ *          code otherwise.
+ */
+int buttonMngrGetEdgeCycle(WheelButtonIdx idx, uint32_t *cycle);
+
+/**
+ * @brief   Get the steps counted by an encoder since the last call. A step
+ *          is one detent and every detent is counted, however many happen
+ *          between two calls.
+ *
+ * @param enc     The encoder index.
+ * @param steps   The signed step count, positive when incrementing.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int buttonMngrGetEncoderSteps(WheelEncoderIdx enc, int32_t *steps);
+
+/**
+ * @brief   Get the invalid transition count of an encoder since boot. A
+ *          rising count is the sign of a bouncing or failing encoder.
+ *
+ * @param enc     The encoder index.
+ * @param count   The invalid transition count.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int buttonMngrGetEncoderNoise(WheelEncoderIdx enc, uint32_t *count);
+
+/**
+ * @brief   Get the column settle time of the matrix scan.
+ *
+ * @return  The column settle time [ns].
+ */
+uint32_t buttonMngrGetSettleTime(void);
+
+/**
+ * @brief   Calibrate the column settle time of the matrix scan. The
+ *          calibration runs in the button thread, before its next scan,
+ *          and needs keys held in each column meanwhile.
+ *
+ * @return  0 if successful, -ENODATA if no key is held, the error code
+ *          otherwise.
+ */
+int buttonMngrCalibrateSettleTime(void);
+
+/**
+ * @brief   Get the button scan statistics.
+ *
+ * @param stats   The scan statistics.
+ */
+void buttonMngrGetScanStats(ButtonMngrScanStats *stats);
+
+/**
+ * @brief   Reset the button scan statistics.
+ */
+void buttonMngrResetScanStats(void);
+
 #endif    /* BUTTON_MNGR */
 
 /** @} */
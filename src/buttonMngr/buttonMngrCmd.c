@@ -0,0 +1,226 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      buttonMngrCmd.c
+ * @author    jbacon
+ * @date      2023-10-17
+ * @brief     Button Manager Command Implementation
+ *
+ *            This file is the implementation of the button manager shell
+ *            commands.
+ *
+ * @ingroup  buttonMngr
+ *
+ * @{
+ */
+
+#include <zephyr/shell/shell.h>
+
+#include "buttonMngr.h"
+
+/** buttons command usage */
+#define BUTTONS_CMD_USAGE         "Button manager related commands."
+
+/** buttons stats command usage */
+#define BUTTONS_STATS_USAGE       "Display the button scan statistics.\n" \
+                                  "Usage: buttons stats"
+
+/** buttons encoders command usage */
+#define BUTTONS_ENCODERS_USAGE    "Display the encoder invalid transition counts.\n" \
+                                  "Usage: buttons encoders"
+
+/** buttons edges command usage */
+#define BUTTONS_EDGES_USAGE       "Display the age of the last edge of each button.\n" \
+                                  "Usage: buttons edges"
+
+/** buttons settle command usage */
+#define BUTTONS_SETTLE_USAGE      "Display the column settle time of the matrix scan.\n" \
+                                  "Usage: buttons settle"
+
+/** buttons calibrate-settle command usage */
+#define BUTTONS_CALIB_SETTLE_USAGE "Recalibrate the column settle time, hold keys in each column meanwhile.\n" \
+                                  "Usage: buttons calibrate-settle"
+
+/** buttons reset-stats command usage */
+#define BUTTONS_RESET_STATS_USAGE "Reset the button scan statistics.\n" \
+                                  "Usage: buttons reset-stats"
+
+/**
+ * Execute the buttons encoders command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execEncoders(const struct shell *shell, size_t argc, char **argv)
+{
+  uint32_t noise;
+  const char *names[ENCODER_COUNT] = {"left", "right", "tc", "tc1", "abs",
+                                      "map"};
+
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
+  {
+    if(buttonMngrGetEncoderNoise(i, &noise) < 0)
+      return -1;
+
+    shell_print(shell, "%s: %u invalid transitions", names[i], noise);
+  }
+
+  return 0;
+}
+
+/**
+ * Execute the buttons edges command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execEdges(const struct shell *shell, size_t argc, char **argv)
+{
+  int rc;
+  uint32_t now;
+  uint32_t cycle;
+
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  now = k_cycle_get_32();
+  for(uint8_t i = 0; i < BUTTON_COUNT; ++i)
+  {
+    rc = buttonMngrGetEdgeCycle(i, &cycle);
+    if(rc == -ENODATA)
+      continue;
+
+    if(rc < 0)
+      return -1;
+
+    shell_print(shell, "button %u: cycle %u, %u us ago", i, cycle,
+                k_cyc_to_us_near32(now - cycle));
+  }
+
+  return 0;
+}
+
+/**
+ * Execute the buttons settle command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execSettle(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  shell_print(shell, "column settle time: %u ns", buttonMngrGetSettleTime());
+
+  return 0;
+}
+
+/**
+ * Execute the buttons calibrate-settle command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execCalibSettle(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  int rc;
+
+  rc = buttonMngrCalibrateSettleTime();
+  if(rc == -ENODATA)
+  {
+    shell_error(shell, "no key held, hold keys in each column");
+    return -1;
+  }
+
+  if(rc < 0)
+  {
+    shell_error(shell, "unable to calibrate the column settle time");
+    return -1;
+  }
+
+  shell_print(shell, "column settle time: %u ns", buttonMngrGetSettleTime());
+
+  return 0;
+}
+
+/**
+ * Execute the buttons stats command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execStats(const struct shell *shell, size_t argc, char **argv)
+{
+  ButtonMngrScanStats stats;
+
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  buttonMngrGetScanStats(&stats);
+
+  shell_print(shell, "scan count: %u", stats.scanCount);
+  shell_print(shell, "nominal period: %u us", stats.periodUs);
+  if(stats.scanCount > 0)
+  {
+    shell_print(shell, "min period: %u us", stats.minPeriodUs);
+    shell_print(shell, "max period: %u us", stats.maxPeriodUs);
+    shell_print(shell, "max jitter: %u us", stats.maxJitterUs);
+  }
+  shell_print(shell, "ghosting scans: %u", stats.ghostCount);
+
+  return 0;
+}
+
+/**
+ * Execute the buttons reset-stats command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execResetStats(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  buttonMngrResetScanStats();
+  shell_print(shell, "scan statistics reset");
+
+  return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(buttons_sub,
+	SHELL_CMD(stats, NULL, BUTTONS_STATS_USAGE, execStats),
+	SHELL_CMD(reset-stats, NULL, BUTTONS_RESET_STATS_USAGE, execResetStats),
+	SHELL_CMD(encoders, NULL, BUTTONS_ENCODERS_USAGE, execEncoders),
+	SHELL_CMD(edges, NULL, BUTTONS_EDGES_USAGE, execEdges),
+	SHELL_CMD(settle, NULL, BUTTONS_SETTLE_USAGE, execSettle),
+	SHELL_CMD(calibrate-settle, NULL, BUTTONS_CALIB_SETTLE_USAGE, execCalibSettle),
+	SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(buttons, &buttons_sub, BUTTONS_CMD_USAGE, NULL);
+
+/** @} */
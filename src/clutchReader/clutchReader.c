@@ -13,11 +13,17 @@
  * @{
  */
 
+#include <string.h>
 #include <zephyr/kernel.h>
+#include <zephyr/drivers/adc.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/util.h>
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+#include <zephyr/settings/settings.h>
+#endif
 
 #include "clutchReader.h"
+#include "signalFilter.h"
 #include "zephyrCommon.h"
 #include "zephyrAdc.h"
 #include "zephyrThread.h"
@@ -33,14 +39,82 @@ LOG_MODULE_REGISTER(CLUTCH_READER_MODULE_NAME);
 #define CLUTCH_READER_STACK_SIZE          256
 
 /**
- * @brief The clutch ADC channel count.
+ * @brief The clutch raw value limit count.
 */
-#define CLUTCH_READER_CHAN_CNT            2
+#define CLUTCH_RAW_LIMIT_CNT              2
 
 /**
- * @brief The clutch raw value limit count.
+ * @brief The clutch travel resolution shift.
 */
-#define CLUTCH_RAW_LIMIT_CNT              2
+#define CLUTCH_TRAVEL_SHIFT               12
+
+/**
+ * @brief The clutch travel resolution, a power of 2 multiple of the curve
+ *        segment count.
+*/
+#define CLUTCH_TRAVEL_MAX                 BIT(CLUTCH_TRAVEL_SHIFT)
+
+/**
+ * @brief The clutch travel per curve segment shift.
+*/
+#define CLUTCH_CURVE_SEGMENT_SHIFT        8
+
+BUILD_ASSERT((CLUTCH_CURVE_POINT_CNT - 1) << CLUTCH_CURVE_SEGMENT_SHIFT ==
+             CLUTCH_TRAVEL_MAX, "the curve segments must span the travel");
+
+/**
+ * @brief The fixed-point scale shift.
+*/
+#define CLUTCH_FIXED_SHIFT                16
+
+/**
+ * @brief The clutch filtered value scale shift.
+*/
+#define CLUTCH_SCALE_BITS                 CONFIG_CLUTCH_READER_OVERSAMPLE_BITS
+
+/**
+ * @brief The calibration margin, in filtered value scale.
+*/
+#define CLUTCH_CALIB_MARGIN                                                  \
+  (CONFIG_CLUTCH_READER_CALIB_MARGIN << CLUTCH_SCALE_BITS)
+
+/**
+ * @brief The calibration minimal paddle span, in filtered value scale.
+*/
+#define CLUTCH_CALIB_MIN_SPAN                                                \
+  (CONFIG_CLUTCH_READER_CALIB_MIN_SPAN << CLUTCH_SCALE_BITS)
+
+/**
+ * @brief The raw value plausibility tolerance, in filtered value scale.
+*/
+#define CLUTCH_PLAUSIBLE_TOLERANCE                                           \
+  (CONFIG_CLUTCH_READER_PLAUSIBLE_TOLERANCE << CLUTCH_SCALE_BITS)
+
+/**
+ * @brief The pressed paddle end is the lowest raw value flag.
+*/
+#define CLUTCH_PRESSED_IS_LOW                                                \
+  (CONFIG_CLUTCH_READER_RAW_PRESSED < CONFIG_CLUTCH_READER_RAW_RELEASED)
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+/**
+ * @brief The clutch settings subtree.
+*/
+#define CLUTCH_SETTINGS_SUBTREE           "clutch"
+
+/**
+ * @brief The clutch limits settings key.
+*/
+#define CLUTCH_SETTINGS_LIMITS_KEY        "limits"
+
+#ifdef CONFIG_CLUTCH_READER_AUTO_CALIB
+/**
+ * @brief The automatic calibration save threshold, in filtered value scale.
+*/
+#define CLUTCH_CALIB_SAVE_DELTA                                              \
+  (CONFIG_CLUTCH_READER_CALIB_SAVE_DELTA << CLUTCH_SCALE_BITS)
+#endif
+#endif
 
 /**
  * @brief The clutch minimal value.
@@ -57,6 +131,73 @@ LOG_MODULE_REGISTER(CLUTCH_READER_MODULE_NAME);
  */
 #define CLUTCH_READER_THREAD_NAME         "clutchReader"
 
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+/**
+ * @brief The clutch ADC resolution [bits].
+*/
+#define CLUTCH_READER_ADC_RES_BITS        12
+
+/**
+ * @brief The clutch stream sampling interval [us].
+*/
+#define CLUTCH_READER_STREAM_INTERVAL_US                                     \
+  (USEC_PER_SEC / CONFIG_CLUTCH_READER_SAMPLE_RATE_HZ)
+
+/**
+ * @brief The clutch stream ring depth.
+*/
+#define CLUTCH_READER_STREAM_DEPTH        CONFIG_CLUTCH_READER_STREAM_DEPTH
+
+#ifndef CONFIG_ZTEST
+/**
+ * @brief The clutch ADC device.
+*/
+static const struct device *adcDev = DEVICE_DT_GET(DT_ALIAS(adc));
+#else
+static const struct device *adcDev = NULL;
+#endif
+
+/**
+ * @brief The stream sequence buffer, written by the ADC driver.
+*/
+static uint16_t streamSamples[CLUTCH_READER_CHAN_CNT];
+
+/**
+ * @brief The stream ring buffer of the sample sets.
+*/
+static uint16_t streamRing[CLUTCH_READER_STREAM_DEPTH][CLUTCH_READER_CHAN_CNT];
+
+/**
+ * @brief The count of sample sets written to the stream ring.
+*/
+static atomic_t streamHead = ATOMIC_INIT(0);
+
+/**
+ * @brief The count of sample sets read from the stream ring.
+*/
+static uint32_t streamTail = 0;
+
+/**
+ * @brief The stream signal, raised by the ADC driver if the stream stops.
+*/
+static struct k_poll_signal streamSignal;
+#endif
+
+/**
+ * @brief The clutch sample rate [Hz], the filter input rate.
+*/
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+#define CLUTCH_READER_SAMPLE_RATE_HZ      CONFIG_CLUTCH_READER_SAMPLE_RATE_HZ
+#else
+#define CLUTCH_READER_SAMPLE_RATE_HZ                                         \
+  (MSEC_PER_SEC / CONFIG_CLUTCH_READER_PERIOD_MS)
+#endif
+
+/**
+ * @brief The clutch filters.
+*/
+static SignalFilter filters[CLUTCH_READER_CHAN_CNT];
+
 K_THREAD_STACK_DEFINE(clutchThreadStack, CLUTCH_READER_STACK_SIZE);
 static ZephyrThread thread = {
   .stack = clutchThreadStack,
@@ -70,6 +211,94 @@ static ZephyrThread thread = {
 */
 static uint32_t rawLimits[CLUTCH_READER_CHAN_CNT][CLUTCH_RAW_LIMIT_CNT];
 
+/**
+ * @brief The clutch raw value to travel scales, derived from the raw limits
+ *        [travel << CLUTCH_FIXED_SHIFT per raw count].
+*/
+static int32_t rawScales[CLUTCH_READER_CHAN_CNT];
+
+/**
+ * @brief The clutch curve lock.
+*/
+static struct k_spinlock curveLock;
+
+/**
+ * @brief The clutch curve lookup table.
+*/
+static uint16_t curveLut[CLUTCH_CURVE_POINT_CNT];
+
+/**
+ * @brief The clutch curve released end deadzone [travel].
+*/
+static uint32_t curveLowDeadzone = 0;
+
+/**
+ * @brief The clutch curve pressed end deadzone [travel].
+*/
+static uint32_t curveHighDeadzone = 0;
+
+/**
+ * @brief The clutch travel scale between the deadzones
+ *        [travel << CLUTCH_FIXED_SHIFT per travel].
+*/
+static uint32_t curveDeadzoneScale = BIT(CLUTCH_FIXED_SHIFT);
+
+/**
+ * @brief The clutch calibration lock.
+*/
+static struct k_spinlock calibLock;
+
+/**
+ * @brief The guided calibration running flag.
+*/
+static bool calibrating = false;
+
+/**
+ * @brief The lowest raw values tracked by the calibration.
+*/
+static uint32_t trackMin[CLUTCH_READER_CHAN_CNT];
+
+/**
+ * @brief The highest raw values tracked by the calibration.
+*/
+static uint32_t trackMax[CLUTCH_READER_CHAN_CNT];
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+/**
+ * @brief The persistent clutch calibration.
+*/
+typedef struct
+{
+  uint32_t limits[CLUTCH_READER_CHAN_CNT][CLUTCH_RAW_LIMIT_CNT];  /**< The raw limits. */
+  uint8_t scaleBits;                      /**< The filtered value scale shift of the raw limits. */
+} ClutchCalibData;
+#endif
+
+#ifdef CONFIG_CLUTCH_READER_AUTO_CALIB
+/**
+ * @brief The uptime of the last automatic calibration decay [ms].
+*/
+static int64_t lastDecayMs = 0;
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+/**
+ * @brief The automatic calibration unsaved widening flag.
+*/
+static bool autoCalibWidened = false;
+
+/**
+ * @brief The saved raw limits, only ever widened by the automatic
+ *        calibration.
+*/
+static uint32_t savedLimits[CLUTCH_READER_CHAN_CNT][CLUTCH_RAW_LIMIT_CNT];
+
+/**
+ * @brief The uptime of the last automatic calibration save [ms].
+*/
+static int64_t lastSaveMs = 0;
+#endif
+#endif
+
 /**
  * @brief The friction point value.
 */
@@ -81,61 +310,610 @@ uint8_t frictionPoint = 127;
 uint8_t clutchState = 0;
 
 /**
- * @brief   Sample the clutch raw values.
+ * @brief The clutch status.
+*/
+ClutchStatus clutchStatus = CLUTCH_STATUS_OK;
+
+/**
+ * @brief   Feed a sample set to the clutch filters.
+ *
+ * @param samples     The clutch samples.
+ * @param rawValues   The clutch filtered values.
+ */
+static void filterClutchSamples(const uint32_t *samples, uint32_t *rawValues)
+{
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    rawValues[i] = signalFilterUpdate(filters + i, samples[i]);
+}
+
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+/**
+ * @brief   Copy the sample set of a stream sampling to the stream ring. The
+ *          ADC driver is asked to repeat the sampling, so the stream runs
+ *          until an error stops it.
+ *
+ * @param dev         The ADC device.
+ * @param sequence    The stream sequence.
+ * @param samplingIdx The sampling index.
+ *
+ * @return  The repeat action.
+ */
+static enum adc_action streamCallback(const struct device *dev,
+                                      const struct adc_sequence *sequence,
+                                      uint16_t samplingIdx)
+{
+  uint32_t head = (uint32_t)atomic_get(&streamHead);
+  const uint16_t *samples = sequence->buffer;
+
+  ARG_UNUSED(dev);
+  ARG_UNUSED(samplingIdx);
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    streamRing[head % CLUTCH_READER_STREAM_DEPTH][i] = samples[i];
+
+  atomic_set(&streamHead, (atomic_val_t)(head + 1));
+
+  return ADC_ACTION_REPEAT;
+}
+
+/**
+ * @brief The clutch stream sequence options.
+*/
+static const struct adc_sequence_options streamOptions = {
+  .interval_us = CLUTCH_READER_STREAM_INTERVAL_US,
+  .callback = streamCallback,
+  .user_data = NULL,
+  .extra_samplings = 0,
+};
+
+/**
+ * @brief The clutch stream sequence.
+*/
+static const struct adc_sequence streamSequence = {
+  .options = &streamOptions,
+  .channels = BIT_MASK(CLUTCH_READER_CHAN_CNT),
+  .buffer = streamSamples,
+  .buffer_size = sizeof(streamSamples),
+  .resolution = CLUTCH_READER_ADC_RES_BITS,
+  .oversampling = 0,
+  .calibrate = false,
+};
+
+/**
+ * @brief   Start the clutch stream.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int startAdcStream(void)
+{
+  k_poll_signal_reset(&streamSignal);
+
+  return adc_read_async(adcDev, &streamSequence, &streamSignal);
+}
+
+/**
+ * @brief   Feed the unread sample sets of the clutch stream to the clutch
+ *          filters. The stream is restarted if it stopped.
+ *
+ * @param rawValues   The clutch filtered values. Since the clutch use 2 ADC
+ *                    channel, this must be an array of 2. No more, no less.
+ *
+ * @return  0 if successful, -EAGAIN if no new sample set is available yet,
+ *          the error code otherwise.
+ */
+static int readStreamValues(uint32_t *rawValues)
+{
+  int rc;
+  int result;
+  unsigned int signaled;
+  uint32_t head;
+  uint32_t samples[CLUTCH_READER_CHAN_CNT];
+  bool filtered = false;
+
+  k_poll_signal_check(&streamSignal, &signaled, &result);
+  if(signaled)
+  {
+    LOG_WRN("clutch stream stopped: %d", result);
+    rc = startAdcStream();
+    if(rc < 0)
+      return rc;
+  }
+
+  head = (uint32_t)atomic_get(&streamHead);
+  if(head == streamTail)
+    return -EAGAIN;
+
+  /* the older sets are already overwritten */
+  if(head - streamTail > CLUTCH_READER_STREAM_DEPTH - 1)
+    streamTail = head - (CLUTCH_READER_STREAM_DEPTH - 1);
+
+  for(; streamTail != head; ++streamTail)
+  {
+    for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+      samples[i] = streamRing[streamTail % CLUTCH_READER_STREAM_DEPTH][i];
+
+    /* skip the set if it was overwritten while copied */
+    if((uint32_t)atomic_get(&streamHead) - streamTail <
+       CLUTCH_READER_STREAM_DEPTH)
+    {
+      filterClutchSamples(samples, rawValues);
+      filtered = true;
+    }
+  }
+
+  return filtered ? 0 : -EAGAIN;
+}
+#endif
+
+/**
+ * @brief   Sample and filter the clutch raw values.
  *
- * @param rawValues   The clutch raw values. Since the clutch use 2 ADC channel,
+ * @param rawValues   The clutch filtered values. Since the clutch use 2 ADC channel,
  *                    this must be an array of 2. No more, no less.
  *
  * @return 0 if successful, the error code otherwise.
  */
 static int sampleClutchRawValues(uint32_t *rawValues)
 {
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+  return readStreamValues(rawValues);
+#else
   int rc = 0;
+  uint32_t samples[CLUTCH_READER_CHAN_CNT];
 
   for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT && rc == 0; ++i)
-    // TODO: filtering might be needed to reduce noise.
-    rc = zephyrAdcGetSample(i, rawValues + i);
+    rc = zephyrAdcGetSample(i, samples + i);
+
+  if(rc == 0)
+    filterClutchSamples(samples, rawValues);
 
   return rc;
+#endif
+}
+
+/**
+ * @brief   Set the raw limits of a clutch channel and derive its raw value to
+ *          travel scale.
+ *
+ * @param chan      The clutch channel.
+ * @param pressed   The fully pressed raw value.
+ * @param released  The released raw value.
+ */
+static void setRawLimits(uint8_t chan, uint32_t pressed, uint32_t released)
+{
+  int32_t span = (int32_t)released - (int32_t)pressed;
+  k_spinlock_key_t key = k_spin_lock(&curveLock);
+
+  rawLimits[chan][0] = pressed;
+  rawLimits[chan][1] = released;
+  rawScales[chan] = span == 0 ? 0 :
+    ((int32_t)CLUTCH_TRAVEL_MAX << CLUTCH_FIXED_SHIFT) / span;
+
+  k_spin_unlock(&curveLock, key);
+}
+
+/**
+ * @brief   Convert a clutch raw value to its travel, 0 when released and
+ *          CLUTCH_TRAVEL_MAX when fully pressed.
+ *
+ * @param chan      The clutch channel.
+ * @param rawValue  The clutch raw value.
+ *
+ * @return  The clutch travel.
+ */
+static uint32_t getClutchTravel(uint8_t chan, uint32_t rawValue)
+{
+  int64_t position;
+
+  /* position from the pressed limit, rounded */
+  position = ((int64_t)((int32_t)rawValue - (int32_t)rawLimits[chan][0]) *
+    rawScales[chan] + (int64_t)BIT(CLUTCH_FIXED_SHIFT - 1)) >>
+    CLUTCH_FIXED_SHIFT;
+  position = CLAMP(position, 0, CLUTCH_TRAVEL_MAX);
+
+  return CLUTCH_TRAVEL_MAX - (uint32_t)position;
+}
+
+/**
+ * @brief   Apply the clutch curve to a travel. The deadzones are cut off and
+ *          the remaining travel is interpolated between the curve points.
+ *
+ * @param travel    The clutch travel.
+ *
+ * @return  The curve output, CLUTCH_CURVE_POINT_MAX being the friction point.
+ */
+static uint32_t applyClutchCurve(uint32_t travel)
+{
+  uint32_t idx;
+  uint32_t frac;
+
+  if(travel <= curveLowDeadzone)
+    return curveLut[0];
+
+  if(travel >= CLUTCH_TRAVEL_MAX - curveHighDeadzone)
+    return curveLut[CLUTCH_CURVE_POINT_CNT - 1];
+
+  travel = ((travel - curveLowDeadzone) * curveDeadzoneScale +
+    BIT(CLUTCH_FIXED_SHIFT - 1)) >> CLUTCH_FIXED_SHIFT;
+  idx = travel >> CLUTCH_CURVE_SEGMENT_SHIFT;
+  if(idx >= CLUTCH_CURVE_POINT_CNT - 1)
+    return curveLut[CLUTCH_CURVE_POINT_CNT - 1];
+
+  frac = travel & BIT_MASK(CLUTCH_CURVE_SEGMENT_SHIFT);
+
+  return curveLut[idx] + (((curveLut[idx + 1] - curveLut[idx]) * frac) >>
+    CLUTCH_CURVE_SEGMENT_SHIFT);
 }
 
 /**
- * @brief   Calculate the clutch state base on the 2 raw values.
+ * @brief   Check if a clutch raw value is plausible, within the raw limits
+ *          widened by the plausibility tolerance. An implausible value means
+ *          an open or shorted paddle sensor.
+ *
+ * @param chan      The clutch channel.
+ * @param rawValue  The clutch raw value.
+ *
+ * @return  True if the raw value is plausible, false otherwise.
+ */
+static bool isRawValuePlausible(uint8_t chan, uint32_t rawValue)
+{
+  uint32_t low = MIN(rawLimits[chan][0], rawLimits[chan][1]);
+  uint32_t high = MAX(rawLimits[chan][0], rawLimits[chan][1]);
+
+  return rawValue + CLUTCH_PLAUSIBLE_TOLERANCE >= low &&
+    rawValue <= high + CLUTCH_PLAUSIBLE_TOLERANCE;
+}
+
+/**
+ * @brief   Calculate the clutch state base on the 2 raw values. Both paddle
+ *          travels are fused: the most pressed paddle is mapped through the
+ *          curve lookup table up to the friction point and the least pressed
+ *          one adds the rest of the range linearly. Releasing either paddle
+ *          thus smoothly drops the clutch to the friction point, and both
+ *          released to 0. An implausible paddle is ignored, as released.
  *
  * @param rawValues     The clutch raw values. Since the clutch use 2 ADC
  *                      channel, this must be an array of 2. No more, no less.
  * @param frictionPoint The clutch friction point.
+ * @param status        The clutch status.
  *
  * @return  The clutch state.
  */
-static uint8_t calculateClutchState(uint32_t *rawValues, uint8_t frictionPoint)
+static uint8_t calculateClutchState(uint32_t *rawValues, uint8_t frictionPoint,
+                                    ClutchStatus *status)
 {
-  // TODO: range might be needed to compensate for noise.
-  uint8_t state;
-  uint8_t rawValIdx = 0;
-  int releasedIdx = -1;
-  uint8_t unreleasedIdx;
-  float positionRatio;
+  uint32_t travels[CLUTCH_READER_CHAN_CNT];
+  uint8_t implausibleCount = 0;
+  uint32_t output;
+  k_spinlock_key_t key = k_spin_lock(&curveLock);
 
-  while(rawValIdx < CLUTCH_READER_CHAN_CNT && releasedIdx < 0)
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
   {
-    if(rawValues[rawValIdx] == rawLimits[rawValIdx][1])
-      releasedIdx = rawValIdx;
-    ++rawValIdx;
+    travels[i] = 0;
+    if(isRawValuePlausible(i, rawValues[i]))
+      travels[i] = getClutchTravel(i, rawValues[i]);
+    else
+      ++implausibleCount;
   }
 
-  if(releasedIdx < 0)
-    state = CLUTCH_MAX_VALUE;
+  /* most pressed paddle up to the friction point, least pressed one above */
+  output = frictionPoint * applyClutchCurve(MAX(travels[0], travels[1])) +
+    (CLUTCH_MAX_VALUE - frictionPoint) * (MIN(travels[0], travels[1]) <<
+      (CLUTCH_FIXED_SHIFT - CLUTCH_TRAVEL_SHIFT));
+
+  k_spin_unlock(&curveLock, key);
+
+  if(implausibleCount == 0)
+    *status = CLUTCH_STATUS_OK;
+  else if(implausibleCount < CLUTCH_READER_CHAN_CNT)
+    *status = CLUTCH_STATUS_DEGRADED;
+  else
+    *status = CLUTCH_STATUS_FAULT;
+
+  return (uint8_t)((output + BIT(CLUTCH_FIXED_SHIFT - 1)) >>
+    CLUTCH_FIXED_SHIFT);
+}
+
+/**
+ * @brief   Apply a tracked raw range to a clutch channel. The range is shrunk
+ *          by the calibration margin, so the paddle ends are reached despite
+ *          the noise.
+ *
+ * @param chan  The clutch channel.
+ * @param low   The lowest raw value.
+ * @param high  The highest raw value.
+ */
+static void applyTrackedRange(uint8_t chan, uint32_t low, uint32_t high)
+{
+  low += CLUTCH_CALIB_MARGIN;
+  high -= CLUTCH_CALIB_MARGIN;
+
+  if(CLUTCH_PRESSED_IS_LOW)
+    setRawLimits(chan, low, high);
   else
+    setRawLimits(chan, high, low);
+}
+
+/**
+ * @brief   Get the raw range of a clutch channel from its raw limits,
+ *          including the calibration margin.
+ *
+ * @param chan  The clutch channel.
+ * @param low   The lowest raw value.
+ * @param high  The highest raw value.
+ */
+static void getLimitRange(uint8_t chan, uint32_t *low, uint32_t *high)
+{
+  k_spinlock_key_t key = k_spin_lock(&curveLock);
+
+  *low = MIN(rawLimits[chan][0], rawLimits[chan][1]);
+  *high = MAX(rawLimits[chan][0], rawLimits[chan][1]);
+
+  k_spin_unlock(&curveLock, key);
+
+  *low = *low > CLUTCH_CALIB_MARGIN ? *low - CLUTCH_CALIB_MARGIN : 0;
+  *high += CLUTCH_CALIB_MARGIN;
+}
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+/**
+ * @brief   Save clutch raw limits.
+ *
+ * @param limits  The raw limits, guarded by the curve lock.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int saveCalibration(uint32_t limits[][CLUTCH_RAW_LIMIT_CNT])
+{
+  ClutchCalibData data = {.scaleBits = CLUTCH_SCALE_BITS};
+  k_spinlock_key_t key = k_spin_lock(&curveLock);
+
+  memcpy(data.limits, limits, sizeof(data.limits));
+
+  k_spin_unlock(&curveLock, key);
+
+  return settings_save_one(CLUTCH_SETTINGS_SUBTREE "/"
+                           CLUTCH_SETTINGS_LIMITS_KEY, &data, sizeof(data));
+}
+
+/**
+ * @brief   Load the clutch raw limits from the settings. The limits are
+ *          rescaled if the oversampling changed since they were saved.
+ *
+ * @param key     The settings key.
+ * @param len     The settings value length.
+ * @param readCb  The settings value read callback.
+ * @param cbArg   The settings value read callback argument.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int setCalibration(const char *key, size_t len,
+                          settings_read_cb readCb, void *cbArg)
+{
+  int rc;
+  const char *next;
+  ClutchCalibData data;
+
+  if(!settings_name_steq(key, CLUTCH_SETTINGS_LIMITS_KEY, &next) || next)
+    return -ENOENT;
+
+  if(len != sizeof(data))
+    return -EINVAL;
+
+  rc = readCb(cbArg, &data, sizeof(data));
+  if(rc < 0)
+    return rc;
+
+  if(data.scaleBits > SIGNAL_FILTER_OVERSAMPLE_MAX)
+    return -EINVAL;
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
   {
-    unreleasedIdx = releasedIdx == 0 ? 1 : 0;
-    positionRatio = ((float)rawValues[unreleasedIdx] - rawLimits[unreleasedIdx][0]) /
-      (rawLimits[unreleasedIdx][1] - rawLimits[unreleasedIdx][0]);
-    positionRatio = 1 - positionRatio;
-    state = (uint8_t)(frictionPoint * positionRatio + 0.5);
+    for(uint8_t j = 0; j < CLUTCH_RAW_LIMIT_CNT; ++j)
+      data.limits[i][j] = (data.limits[i][j] << CLUTCH_SCALE_BITS) >>
+        data.scaleBits;
+
+    setRawLimits(i, data.limits[i][0], data.limits[i][1]);
   }
 
-  return state;
+  LOG_INF("clutch calibration loaded");
+
+  return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(clutch, CLUTCH_SETTINGS_SUBTREE, NULL,
+                               setCalibration, NULL, NULL);
+#endif
+
+#ifdef CONFIG_CLUTCH_READER_AUTO_CALIB
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+/**
+ * @brief   Automatic calibration save work handler. The flash write runs on
+ *          the system workqueue, off the clutch thread stack.
+ *
+ * @param work    The work item.
+ */
+static void autoCalibSaveHandler(struct k_work *work)
+{
+  ARG_UNUSED(work);
+
+  if(saveCalibration(savedLimits) < 0)
+    LOG_WRN("unable to save the clutch calibration");
+}
+
+/**
+ * @brief   Reset the saved raw limits to the current ones, once these are
+ *          loaded or set by a guided calibration.
+ */
+static void resetSavedLimits(void)
+{
+  k_spinlock_key_t key = k_spin_lock(&curveLock);
+
+  memcpy(savedLimits, rawLimits, sizeof(savedLimits));
+
+  k_spin_unlock(&curveLock, key);
+}
+
+/**
+ * @brief   Widen the saved raw limits to the current ones, if these are
+ *          wider by more than the save threshold at any paddle end. The
+ *          decayed ends never narrow the saved raw limits.
+ *
+ * @return  True if the saved raw limits are widened, false otherwise.
+ */
+static bool widenSavedLimits(void)
+{
+  uint32_t low;
+  uint32_t high;
+  uint32_t savedLow;
+  uint32_t savedHigh;
+  bool widened = false;
+  k_spinlock_key_t key = k_spin_lock(&curveLock);
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    low = MIN(rawLimits[i][0], rawLimits[i][1]);
+    high = MAX(rawLimits[i][0], rawLimits[i][1]);
+    savedLow = MIN(savedLimits[i][0], savedLimits[i][1]);
+    savedHigh = MAX(savedLimits[i][0], savedLimits[i][1]);
+
+    widened |= low + CLUTCH_CALIB_SAVE_DELTA < savedLow ||
+      high > savedHigh + CLUTCH_CALIB_SAVE_DELTA;
+  }
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT && widened; ++i)
+  {
+    low = MIN(rawLimits[i][0], rawLimits[i][1]);
+    high = MAX(rawLimits[i][0], rawLimits[i][1]);
+    savedLow = MIN(MIN(savedLimits[i][0], savedLimits[i][1]), low);
+    savedHigh = MAX(MAX(savedLimits[i][0], savedLimits[i][1]), high);
+
+    /* the current paddle orientation is kept */
+    if(rawLimits[i][0] <= rawLimits[i][1])
+    {
+      savedLimits[i][0] = savedLow;
+      savedLimits[i][1] = savedHigh;
+    }
+    else
+    {
+      savedLimits[i][0] = savedHigh;
+      savedLimits[i][1] = savedLow;
+    }
+  }
+
+  k_spin_unlock(&curveLock, key);
+
+  return widened;
+}
+
+/**
+ * @brief The automatic calibration save work.
+*/
+K_WORK_DEFINE(autoCalibSaveWork, autoCalibSaveHandler);
+#endif
+
+/**
+ * @brief   Track the clutch raw range continuously. A raw value beyond the
+ *          range widens it at once and the range slowly decays inward, so a
+ *          spike does not stick. The implausible values are ignored. Only
+ *          the widenings beyond the save threshold are saved, at a limited
+ *          rate, by the system workqueue.
+ *
+ * @param rawValues   The clutch filtered values.
+ */
+static void autoCalibrate(const uint32_t *rawValues)
+{
+  uint32_t low;
+  uint32_t high;
+  bool widened;
+  bool decayed;
+  bool plausible;
+  bool decay = false;
+  k_spinlock_key_t key;
+  int64_t now = k_uptime_get();
+
+  if(CONFIG_CLUTCH_READER_CALIB_DECAY_MS > 0 &&
+     now - lastDecayMs >= CONFIG_CLUTCH_READER_CALIB_DECAY_MS)
+  {
+    lastDecayMs = now;
+    decay = true;
+  }
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    /* an open or shorted sensor must not become the new limit */
+    key = k_spin_lock(&curveLock);
+    plausible = isRawValuePlausible(i, rawValues[i]);
+    k_spin_unlock(&curveLock, key);
+    if(!plausible)
+      continue;
+
+    getLimitRange(i, &low, &high);
+    widened = rawValues[i] < low || rawValues[i] > high;
+    decayed = !widened && decay &&
+      high - low > CLUTCH_CALIB_MIN_SPAN + 2 * CLUTCH_CALIB_MARGIN;
+
+    if(widened)
+    {
+      low = MIN(low, rawValues[i]);
+      high = MAX(high, rawValues[i]);
+    }
+    else if(decayed)
+    {
+      ++low;
+      --high;
+    }
+
+    if(widened || decayed)
+      applyTrackedRange(i, low, high);
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+    autoCalibWidened |= widened;
+#endif
+  }
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+  if(autoCalibWidened &&
+     now - lastSaveMs >= CONFIG_CLUTCH_READER_CALIB_SAVE_S * MSEC_PER_SEC)
+  {
+    autoCalibWidened = false;
+    if(widenSavedLimits())
+    {
+      lastSaveMs = now;
+      k_work_submit(&autoCalibSaveWork);
+    }
+  }
+#endif
+}
+#endif
+
+/**
+ * @brief   Track the clutch raw range for the guided and the automatic
+ *          calibrations.
+ *
+ * @param rawValues   The clutch filtered values.
+ */
+static void trackClutchRange(const uint32_t *rawValues)
+{
+  bool guided;
+  k_spinlock_key_t key = k_spin_lock(&calibLock);
+
+  guided = calibrating;
+  if(guided)
+  {
+    for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    {
+      trackMin[i] = MIN(trackMin[i], rawValues[i]);
+      trackMax[i] = MAX(trackMax[i], rawValues[i]);
+    }
+  }
+
+  k_spin_unlock(&calibLock, key);
+
+#ifdef CONFIG_CLUTCH_READER_AUTO_CALIB
+  if(!guided)
+    autoCalibrate(rawValues);
+#endif
 }
 
 /**
@@ -153,16 +931,88 @@ static void clutchReaderThread(void *p1, void *p2, void *p3)
   for(;;)
   {
     rc = sampleClutchRawValues(rawValues);
-    if(rc < 0)
+    if(rc < 0 && rc != -EAGAIN)
       // TODO: fatal error management.
       return;
 
-    clutchState = calculateClutchState(rawValues, frictionPoint);
+    /* checked against the limits before the tracking can move them */
+    if(rc == 0)
+    {
+      clutchState = calculateClutchState(rawValues, frictionPoint,
+                                         &clutchStatus);
+      trackClutchRange(rawValues);
+    }
 
-    zephyrThreadSleepMs(100);
+    zephyrThreadSleepMs(CONFIG_CLUTCH_READER_PERIOD_MS);
   }
 }
 
+/**
+ * @brief   Initialize the clutch filters.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int initFilters(void)
+{
+  int rc = 0;
+  SignalFilterConfig config = {
+    .sampleRateHz = CLUTCH_READER_SAMPLE_RATE_HZ,
+    .medianSize = CONFIG_CLUTCH_READER_MEDIAN_SIZE,
+    .oversampleBits = CONFIG_CLUTCH_READER_OVERSAMPLE_BITS,
+#ifdef CONFIG_CLUTCH_READER_ONE_EURO
+    .minCutoffMilliHz = CONFIG_CLUTCH_READER_ONE_EURO_MIN_CUTOFF_MHZ,
+    .betaMicro = CONFIG_CLUTCH_READER_ONE_EURO_BETA_MICRO,
+    .derivCutoffMilliHz = CONFIG_CLUTCH_READER_ONE_EURO_DERIV_CUTOFF_MHZ,
+#else
+    .minCutoffMilliHz = 0,
+    .betaMicro = 0,
+    .derivCutoffMilliHz = 0,
+#endif
+  };
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT && rc == 0; ++i)
+    rc = signalFilterInit(filters + i, &config);
+
+  return rc;
+}
+
+/**
+ * @brief   Initialize the clutch raw limits and curve from the configuration.
+ *          The raw limits are scaled like the filtered values.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int initClutchCurve(void)
+{
+  int rc;
+  ClutchCurve curve;
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    setRawLimits(i, CONFIG_CLUTCH_READER_RAW_PRESSED << CLUTCH_SCALE_BITS,
+                 CONFIG_CLUTCH_READER_RAW_RELEASED << CLUTCH_SCALE_BITS);
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+  /* the saved calibration overrides the default raw limits */
+  rc = settings_subsys_init();
+  if(rc == 0)
+    rc = settings_load_subtree(CLUTCH_SETTINGS_SUBTREE);
+  if(rc < 0)
+    LOG_WRN("unable to load the clutch calibration");
+
+#ifdef CONFIG_CLUTCH_READER_AUTO_CALIB
+  resetSavedLimits();
+#endif
+#endif
+
+  rc = clutchReaderBuildCurve(CONFIG_CLUTCH_READER_CURVE,
+                              CONFIG_CLUTCH_READER_LOW_DEADZONE,
+                              CONFIG_CLUTCH_READER_HIGH_DEADZONE, &curve);
+  if(rc < 0)
+    return rc;
+
+  return clutchReaderSetCurve(&curve);
+}
+
 int clutchReaderInit(void)
 {
   int rc;
@@ -180,6 +1030,30 @@ int clutchReaderInit(void)
   if(rc < 0)
     return rc;
 
+  rc = initFilters();
+  if(rc < 0)
+  {
+    LOG_ERR("invalid clutch filter configuration");
+    return rc;
+  }
+
+  rc = initClutchCurve();
+  if(rc < 0)
+  {
+    LOG_ERR("invalid clutch curve configuration");
+    return rc;
+  }
+
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+  k_poll_signal_init(&streamSignal);
+  rc = startAdcStream();
+  if(rc < 0)
+  {
+    LOG_ERR("unable to start the clutch stream");
+    return rc;
+  }
+#endif
+
   thread.entry = clutchReaderThread;
   thread.p1 = NULL;
   thread.p2 = NULL;
@@ -195,4 +1069,157 @@ uint8_t clutchReaderGetState(void)
   return clutchState;
 }
 
+ClutchStatus clutchReaderGetStatus(void)
+{
+  return clutchStatus;
+}
+
+int clutchReaderBuildCurve(ClutchCurveShape shape, uint8_t lowDeadzone,
+                           uint8_t highDeadzone, ClutchCurve *curve)
+{
+  const uint32_t last = CLUTCH_CURVE_POINT_CNT - 1;
+  uint32_t rest;
+
+  if(shape >= CLUTCH_CURVE_SHAPE_COUNT ||
+     lowDeadzone > CLUTCH_CURVE_DEADZONE_MAX ||
+     highDeadzone > CLUTCH_CURVE_DEADZONE_MAX)
+    return -EINVAL;
+
+  for(uint32_t i = 0; i <= last; ++i)
+  {
+    rest = last - i;
+    switch(shape)
+    {
+      case CLUTCH_CURVE_PROGRESSIVE:
+        curve->points[i] = i * i * CLUTCH_CURVE_POINT_MAX / (last * last);
+        break;
+      case CLUTCH_CURVE_BITE:
+        curve->points[i] = CLUTCH_CURVE_POINT_MAX -
+          rest * rest * CLUTCH_CURVE_POINT_MAX / (last * last);
+        break;
+      default:
+        curve->points[i] = i * CLUTCH_CURVE_POINT_MAX / last;
+        break;
+    }
+  }
+
+  curve->lowDeadzone = lowDeadzone;
+  curve->highDeadzone = highDeadzone;
+
+  return 0;
+}
+
+int clutchReaderStartCalib(void)
+{
+  k_spinlock_key_t key = k_spin_lock(&calibLock);
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    trackMin[i] = UINT32_MAX;
+    trackMax[i] = 0;
+  }
+  calibrating = true;
+
+  k_spin_unlock(&calibLock, key);
+
+  return 0;
+}
+
+int clutchReaderStopCalib(void)
+{
+  int rc = 0;
+  uint32_t low[CLUTCH_READER_CHAN_CNT];
+  uint32_t high[CLUTCH_READER_CHAN_CNT];
+  k_spinlock_key_t key = k_spin_lock(&calibLock);
+
+  if(!calibrating)
+    rc = -EINVAL;
+
+  calibrating = false;
+  memcpy(low, trackMin, sizeof(low));
+  memcpy(high, trackMax, sizeof(high));
+
+  k_spin_unlock(&calibLock, key);
+
+  if(rc < 0)
+    return rc;
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    if(high[i] < low[i] ||
+       high[i] - low[i] < CLUTCH_CALIB_MIN_SPAN + 2 * CLUTCH_CALIB_MARGIN)
+      return -ERANGE;
+  }
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    applyTrackedRange(i, low[i], high[i]);
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+  rc = saveCalibration(rawLimits);
+#ifdef CONFIG_CLUTCH_READER_AUTO_CALIB
+  resetSavedLimits();
+#endif
+#endif
+
+  return rc;
+}
+
+void clutchReaderCancelCalib(void)
+{
+  k_spinlock_key_t key = k_spin_lock(&calibLock);
+
+  calibrating = false;
+
+  k_spin_unlock(&calibLock, key);
+}
+
+int clutchReaderGetLimits(uint8_t chan, uint32_t *pressed, uint32_t *released)
+{
+  k_spinlock_key_t key;
+
+  if(chan >= CLUTCH_READER_CHAN_CNT)
+    return -EINVAL;
+
+  key = k_spin_lock(&curveLock);
+
+  *pressed = rawLimits[chan][0];
+  *released = rawLimits[chan][1];
+
+  k_spin_unlock(&curveLock, key);
+
+  return 0;
+}
+
+int clutchReaderSetCurve(const ClutchCurve *curve)
+{
+  uint32_t lowDeadzone;
+  uint32_t highDeadzone;
+  k_spinlock_key_t key;
+
+  if(curve->lowDeadzone > CLUTCH_CURVE_DEADZONE_MAX ||
+     curve->highDeadzone > CLUTCH_CURVE_DEADZONE_MAX)
+    return -EINVAL;
+
+  for(uint8_t i = 1; i < CLUTCH_CURVE_POINT_CNT; ++i)
+  {
+    if(curve->points[i] < curve->points[i - 1])
+      return -EINVAL;
+  }
+
+  lowDeadzone = curve->lowDeadzone * CLUTCH_TRAVEL_MAX / 100;
+  highDeadzone = curve->highDeadzone * CLUTCH_TRAVEL_MAX / 100;
+
+  key = k_spin_lock(&curveLock);
+
+  memcpy(curveLut, curve->points, sizeof(curveLut));
+  curveLowDeadzone = lowDeadzone;
+  curveHighDeadzone = highDeadzone;
+  curveDeadzoneScale = (CLUTCH_TRAVEL_MAX << CLUTCH_FIXED_SHIFT) /
+    (CLUTCH_TRAVEL_MAX - lowDeadzone - highDeadzone);
+
+  k_spin_unlock(&curveLock, key);
+
+  return 0;
+}
+
 /** @} */
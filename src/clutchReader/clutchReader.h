@@ -16,6 +16,60 @@
 #ifndef CLUTCH_READER
 #define CLUTCH_READER
 
+#include <zephyr/kernel.h>
+
+/**
+ * @brief The clutch ADC channel count, one per paddle.
+*/
+#define CLUTCH_READER_CHAN_CNT            2
+
+/**
+ * @brief The clutch curve point count, evenly spread over the clutch travel.
+*/
+#define CLUTCH_CURVE_POINT_CNT            17
+
+/**
+ * @brief The clutch curve maximal point value, the friction point.
+*/
+#define CLUTCH_CURVE_POINT_MAX            UINT16_MAX
+
+/**
+ * @brief The maximal deadzone of each clutch travel end [%].
+*/
+#define CLUTCH_CURVE_DEADZONE_MAX         45
+
+/**
+ * @brief The clutch curve shapes. The values match the Kconfig
+ *        CLUTCH_READER_CURVE symbol.
+*/
+typedef enum
+{
+  CLUTCH_CURVE_LINEAR = 0,                /**< Linear: the output follows the travel. */
+  CLUTCH_CURVE_PROGRESSIVE,               /**< Progressive: fine control at the start of the travel. */
+  CLUTCH_CURVE_BITE,                      /**< Bite: fine control close to the friction point. */
+  CLUTCH_CURVE_SHAPE_COUNT,               /**< The clutch curve shape count. */
+} ClutchCurveShape;
+
+/**
+ * @brief The clutch status, from the paddle sensors plausibility.
+*/
+typedef enum
+{
+  CLUTCH_STATUS_OK = 0,                   /**< Both paddle sensors are plausible. */
+  CLUTCH_STATUS_DEGRADED,                 /**< One paddle sensor is implausible and ignored. */
+  CLUTCH_STATUS_FAULT,                    /**< Both paddle sensors are implausible, the clutch is released. */
+} ClutchStatus;
+
+/**
+ * @brief The clutch response curve.
+*/
+typedef struct
+{
+  uint16_t points[CLUTCH_CURVE_POINT_CNT];  /**< The output at each travel point, CLUTCH_CURVE_POINT_MAX being the friction point. */
+  uint8_t lowDeadzone;                    /**< The released end deadzone [% of travel]. */
+  uint8_t highDeadzone;                   /**< The pressed end deadzone [% of travel]. */
+} ClutchCurve;
+
 /**
  * @brief   Initialize the clutch reader.
  *
@@ -30,6 +84,69 @@ int clutchReaderInit(void);
  */
 uint8_t clutchReaderGetState(void);
 
+/**
+ * @brief   Get the clutch status.
+ *
+ * @return  The clutch status.
+ */
+ClutchStatus clutchReaderGetStatus(void);
+
+/**
+ * @brief   Build a clutch curve from a predefined shape.
+ *
+ * @param shape         The curve shape.
+ * @param lowDeadzone   The released end deadzone [% of travel].
+ * @param highDeadzone  The pressed end deadzone [% of travel].
+ * @param curve         The built curve.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int clutchReaderBuildCurve(ClutchCurveShape shape, uint8_t lowDeadzone,
+                           uint8_t highDeadzone, ClutchCurve *curve);
+
+/**
+ * @brief   Set the clutch response curve. The points must not decrease.
+ *
+ * @param curve   The clutch curve.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int clutchReaderSetCurve(const ClutchCurve *curve);
+
+/**
+ * @brief   Start the guided clutch calibration. The clutch raw range is
+ *          tracked until the calibration is stopped, both paddles must be
+ *          moved through their full travel meanwhile.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int clutchReaderStartCalib(void);
+
+/**
+ * @brief   Stop the guided clutch calibration. The tracked range becomes the
+ *          clutch raw limits, which are saved if persistent.
+ *
+ * @return  0 if successful, -ERANGE if a paddle travel is too short, the
+ *          error code otherwise.
+ */
+int clutchReaderStopCalib(void);
+
+/**
+ * @brief   Cancel the guided clutch calibration, the raw limits are kept.
+ */
+void clutchReaderCancelCalib(void);
+
+/**
+ * @brief   Get the raw limits of a clutch channel.
+ *
+ * @param chan      The clutch channel.
+ * @param pressed   The fully pressed raw value.
+ * @param released  The released raw value.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int clutchReaderGetLimits(uint8_t chan, uint32_t *pressed, uint32_t *released);
+
 #endif    /* CLUTCH_READER */
 
 /** @} */
@@ -0,0 +1,189 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      clutchReaderCmd.c
+ * @author    jbacon
+ * @date      2023-11-13
+ * @brief     Clutch Reader Command Implementation
+ *
+ *            This file is the implementation of the clutch reader shell
+ *            commands.
+ *
+ * @ingroup  clutchReader
+ *
+ * @{
+ */
+
+#include <zephyr/shell/shell.h>
+
+#include "clutchReader.h"
+
+/** clutch command usage */
+#define CLUTCH_CMD_USAGE              "Clutch reader related commands."
+
+/** clutch status command usage */
+#define CLUTCH_STATUS_USAGE           "Display the clutch state and status.\n" \
+                                      "Usage: clutch status"
+
+/** clutch limits command usage */
+#define CLUTCH_LIMITS_USAGE           "Display the clutch raw limits.\n" \
+                                      "Usage: clutch limits"
+
+/** clutch calib-start command usage */
+#define CLUTCH_CALIB_START_USAGE      "Start the clutch calibration, then move both paddles through their full travel.\n" \
+                                      "Usage: clutch calib-start"
+
+/** clutch calib-stop command usage */
+#define CLUTCH_CALIB_STOP_USAGE       "Stop the clutch calibration and save the raw limits.\n" \
+                                      "Usage: clutch calib-stop"
+
+/** clutch calib-cancel command usage */
+#define CLUTCH_CALIB_CANCEL_USAGE     "Cancel the clutch calibration, the raw limits are kept.\n" \
+                                      "Usage: clutch calib-cancel"
+
+/**
+ * Execute the clutch status command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execStatus(const struct shell *shell, size_t argc, char **argv)
+{
+  const char *names[] = {"ok", "degraded", "fault"};
+  ClutchStatus status = clutchReaderGetStatus();
+
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  shell_print(shell, "state: %u", clutchReaderGetState());
+  shell_print(shell, "status: %s", names[status]);
+
+  return 0;
+}
+
+/**
+ * Execute the clutch limits command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execLimits(const struct shell *shell, size_t argc, char **argv)
+{
+  uint32_t pressed;
+  uint32_t released;
+
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    if(clutchReaderGetLimits(i, &pressed, &released) < 0)
+      return -1;
+
+    shell_print(shell, "paddle %u: pressed %u, released %u", i, pressed,
+                released);
+  }
+
+  return 0;
+}
+
+/**
+ * Execute the clutch calib-start command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execCalibStart(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  if(clutchReaderStartCalib() < 0)
+  {
+    shell_error(shell, "unable to start the clutch calibration");
+    return -1;
+  }
+
+  shell_print(shell, "move both paddles through their full travel, then run "
+              "clutch calib-stop");
+
+  return 0;
+}
+
+/**
+ * Execute the clutch calib-stop command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execCalibStop(const struct shell *shell, size_t argc, char **argv)
+{
+  int rc;
+
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  rc = clutchReaderStopCalib();
+  if(rc == -ERANGE)
+  {
+    shell_error(shell, "paddle travel too short, calibration discarded");
+    return -1;
+  }
+
+  if(rc < 0)
+  {
+    shell_error(shell, "unable to complete the clutch calibration: %d", rc);
+    return -1;
+  }
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+  shell_print(shell, "clutch calibration saved");
+#else
+  shell_print(shell, "clutch calibration applied");
+#endif
+
+  return execLimits(shell, argc, argv);
+}
+
+/**
+ * Execute the clutch calib-cancel command
+ *
+ * @param shell     Handle to the shell
+ * @param argc      Command argument count
+ * @param argv      Pointer to the array of arguments
+ *
+ * @return 0 if successful, -1 otherwise
+ */
+static int execCalibCancel(const struct shell *shell, size_t argc, char **argv)
+{
+  ARG_UNUSED(argc);
+  ARG_UNUSED(argv);
+
+  clutchReaderCancelCalib();
+  shell_print(shell, "clutch calibration canceled");
+
+  return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(clutch_sub,
+	SHELL_CMD(status, NULL, CLUTCH_STATUS_USAGE, execStatus),
+	SHELL_CMD(limits, NULL, CLUTCH_LIMITS_USAGE, execLimits),
+	SHELL_CMD(calib-start, NULL, CLUTCH_CALIB_START_USAGE, execCalibStart),
+	SHELL_CMD(calib-stop, NULL, CLUTCH_CALIB_STOP_USAGE, execCalibStop),
+	SHELL_CMD(calib-cancel, NULL, CLUTCH_CALIB_CANCEL_USAGE, execCalibCancel),
+	SHELL_SUBCMD_SET_END);
+SHELL_CMD_REGISTER(clutch, &clutch_sub, CLUTCH_CMD_USAGE, NULL);
+
+/** @} */
@@ -0,0 +1,133 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      debounce.c
+ * @author    jbacon
+ * @date      2023-10-17
+ * @brief     Debounce Module
+ *
+ *            This file is the implementation of the debounce module.
+ *
+ * @ingroup  debounce
+ *
+ * @{
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "debounce.h"
+
+/**
+ * @brief   Update the debounced state with the integrator algorithm. Each
+ *          key counter integrates its raw level between 0 and the sample
+ *          count and the key changes state when its counter reaches a bound.
+ *
+ * @param debouncer   The debouncer.
+ * @param raw         The raw key levels.
+ */
+static void updateIntegrator(Debouncer *debouncer, uint32_t raw)
+{
+  for(uint8_t key = 0; key < DEBOUNCE_MAX_KEY_CNT; ++key)
+  {
+    if(!(debouncer->keyMask & BIT(key)))
+      continue;
+
+    if(raw & BIT(key))
+    {
+      if(debouncer->counters[key] < debouncer->samples)
+        ++debouncer->counters[key];
+    }
+    else if(debouncer->counters[key] > 0)
+      --debouncer->counters[key];
+
+    if(debouncer->counters[key] == debouncer->samples)
+      debouncer->state |= BIT(key);
+    else if(debouncer->counters[key] == 0)
+      debouncer->state &= ~BIT(key);
+  }
+}
+
+/**
+ * @brief   Update the debounced state with the eager algorithm. A key change
+ *          is reported on its first edge and the key is then locked out.
+ *
+ * @param debouncer   The debouncer.
+ * @param raw         The raw key levels.
+ */
+static void updateEager(Debouncer *debouncer, uint32_t raw)
+{
+  uint32_t changed = (raw ^ debouncer->state) & debouncer->keyMask;
+
+  for(uint8_t key = 0; key < DEBOUNCE_MAX_KEY_CNT; ++key)
+  {
+    if(debouncer->counters[key] > 0)
+      --debouncer->counters[key];
+    else if(changed & BIT(key))
+    {
+      debouncer->state ^= BIT(key);
+      debouncer->counters[key] = debouncer->samples;
+    }
+  }
+}
+
+/**
+ * @brief   Update the debounced state with the vertical counter algorithm.
+ *          Each key has a 2 bits counter sliced across 2 words, so all keys
+ *          are processed in a few word operations. A key changes state after
+ *          4 agreeing samples.
+ *
+ * @param debouncer   The debouncer.
+ * @param raw         The raw key levels.
+ */
+static void updateVertical(Debouncer *debouncer, uint32_t raw)
+{
+  uint32_t changed = (raw ^ debouncer->state) & debouncer->keyMask;
+
+  debouncer->vertCnt0 = ~(debouncer->vertCnt0 & changed);
+  debouncer->vertCnt1 = debouncer->vertCnt0 ^ (debouncer->vertCnt1 & changed);
+  debouncer->state ^= changed & debouncer->vertCnt0 & debouncer->vertCnt1;
+}
+
+int debounceInit(Debouncer *debouncer, DebounceAlgo algo, uint8_t keyCount,
+                 uint8_t samples)
+{
+  if(algo >= DEBOUNCE_ALGO_COUNT || keyCount == 0 ||
+     keyCount > DEBOUNCE_MAX_KEY_CNT || samples == 0)
+    return -EINVAL;
+
+  debouncer->algo = algo;
+  debouncer->keyMask = keyCount == DEBOUNCE_MAX_KEY_CNT ? UINT32_MAX :
+    BIT(keyCount) - 1;
+  debouncer->samples = samples;
+  debouncer->state = 0;
+  debouncer->vertCnt0 = UINT32_MAX;
+  debouncer->vertCnt1 = UINT32_MAX;
+  memset(debouncer->counters, 0, sizeof(debouncer->counters));
+
+  return 0;
+}
+
+uint32_t debounceUpdate(Debouncer *debouncer, uint32_t raw)
+{
+  switch(debouncer->algo)
+  {
+    case DEBOUNCE_INTEGRATOR:
+      updateIntegrator(debouncer, raw);
+      break;
+    case DEBOUNCE_EAGER:
+      updateEager(debouncer, raw);
+      break;
+    case DEBOUNCE_VERTICAL:
+      updateVertical(debouncer, raw);
+      break;
+    default:
+      debouncer->state = raw & debouncer->keyMask;
+      break;
+  }
+
+  return debouncer->state;
+}
+
+/** @} */
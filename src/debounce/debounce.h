@@ -0,0 +1,86 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      debounce.h
+ * @author    jbacon
+ * @date      2023-10-17
+ * @brief     Debounce Module
+ *
+ *            This file is the declaration of the debounce module. A
+ *            debouncer filters up to 32 keys packed in a word, bit n being
+ *            key n.
+ *
+ * @defgroup  debounce debounce
+ *
+ * @{
+ */
+
+#ifndef DEBOUNCE
+#define DEBOUNCE
+
+#include <zephyr/kernel.h>
+
+/**
+ * @brief The maximal key count of a debouncer.
+*/
+#define DEBOUNCE_MAX_KEY_CNT          32
+
+/**
+ * @brief The sample count of the vertical counter algorithm.
+*/
+#define DEBOUNCE_VERTICAL_SAMPLE_CNT  4
+
+/**
+ * @brief The debounce algorithms. The values match the Kconfig
+ *        <group>_DEBOUNCE_ALGO symbols.
+*/
+typedef enum
+{
+  DEBOUNCE_NONE = 0,                      /**< No debouncing, raw levels are reported. */
+  DEBOUNCE_INTEGRATOR,                    /**< Integrator: a key level is integrated over N samples. */
+  DEBOUNCE_EAGER,                         /**< Eager: report the first edge, then lock out for N samples. */
+  DEBOUNCE_VERTICAL,                      /**< Vertical counter: bit-sliced 4 samples integrator. */
+  DEBOUNCE_ALGO_COUNT,                    /**< The debounce algorithm count. */
+} DebounceAlgo;
+
+/**
+ * @brief The debouncer.
+*/
+typedef struct
+{
+  DebounceAlgo algo;                      /**< The debounce algorithm. */
+  uint32_t keyMask;                       /**< The debounced key mask. */
+  uint8_t samples;                        /**< The integrator/lock out sample count. */
+  uint32_t state;                         /**< The debounced state. */
+  uint32_t vertCnt0;                      /**< The vertical counter bit 0. */
+  uint32_t vertCnt1;                      /**< The vertical counter bit 1. */
+  uint8_t counters[DEBOUNCE_MAX_KEY_CNT]; /**< The integrator/lock out counters. */
+} Debouncer;
+
+/**
+ * @brief   Initialize a debouncer. All keys start released.
+ *
+ * @param debouncer   The debouncer.
+ * @param algo        The debounce algorithm.
+ * @param keyCount    The key count.
+ * @param samples     The integrator/lock out sample count. Ignored by the
+ *                    none and vertical counter algorithms.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int debounceInit(Debouncer *debouncer, DebounceAlgo algo, uint8_t keyCount,
+                 uint8_t samples);
+
+/**
+ * @brief   Feed a raw sample to a debouncer.
+ *
+ * @param debouncer   The debouncer.
+ * @param raw         The raw key levels.
+ *
+ * @return  The debounced key states.
+ */
+uint32_t debounceUpdate(Debouncer *debouncer, uint32_t raw);
+
+#endif    /* DEBOUNCE */
+
+/** @} */
@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      encoderQdec.c
+ * @author    jbacon
+ * @date      2023-10-24
+ * @brief     Encoder QDEC Module
+ *
+ *            This file is the implementation of the encoder QDEC module.
+ *
+ * @ingroup  encoderQdec
+ *
+ * @{
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/sensor.h>
+
+#include "encoderQdec.h"
+
+/**
+ * @brief The micro-degree count in a revolution.
+*/
+#define ENCODER_QDEC_UDEG_PER_REV   (360LL * 1000000LL)
+
+/**
+ * @brief   Read the QDEC position in counts. The sensor reports the position
+ *          as a rotation angle, which is converted back to the nearest count.
+ *
+ * @param qdec    The encoder QDEC.
+ * @param count   The position count.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+static int readCount(EncoderQdec *qdec, int32_t *count)
+{
+  int rc;
+  int64_t uDeg;
+  struct sensor_value rotation;
+
+  rc = sensor_sample_fetch(qdec->dev);
+  if(rc < 0)
+    return rc;
+
+  rc = sensor_channel_get(qdec->dev, SENSOR_CHAN_ROTATION, &rotation);
+  if(rc < 0)
+    return rc;
+
+  uDeg = (int64_t)rotation.val1 * 1000000LL + rotation.val2;
+  *count = (int32_t)((uDeg * qdec->countsPerRev +
+    ENCODER_QDEC_UDEG_PER_REV / 2) / ENCODER_QDEC_UDEG_PER_REV);
+  *count %= (int32_t)qdec->countsPerRev;
+
+  return 0;
+}
+
+int encoderQdecInit(EncoderQdec *qdec)
+{
+  if(!qdec->dev || qdec->countsPerRev == 0)
+    return -EINVAL;
+
+  if(!device_is_ready(qdec->dev))
+    return -ENODEV;
+
+  return readCount(qdec, &qdec->lastCount);
+}
+
+int encoderQdecReadDelta(EncoderQdec *qdec, int32_t *delta)
+{
+  int rc;
+  int32_t count;
+  int32_t countsPerRev = (int32_t)qdec->countsPerRev;
+
+  rc = readCount(qdec, &count);
+  if(rc < 0)
+    return rc;
+
+  *delta = count - qdec->lastCount;
+  if(*delta > countsPerRev / 2)
+    *delta -= countsPerRev;
+  else if(*delta < -countsPerRev / 2)
+    *delta += countsPerRev;
+
+  qdec->lastCount = count;
+
+  return 0;
+}
+
+/** @} */
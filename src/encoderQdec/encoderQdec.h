@@ -0,0 +1,57 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      encoderQdec.h
+ * @author    jbacon
+ * @date      2023-10-24
+ * @brief     Encoder QDEC Module
+ *
+ *            This file is the declaration of the encoder QDEC module. It
+ *            reads the position of an encoder counted in hardware by a
+ *            quadrature decoder sensor (e.g. a STM32 timer in encoder
+ *            mode) and turns it into count deltas.
+ *
+ * @defgroup  encoderQdec encoder-qdec
+ *
+ * @{
+ */
+
+#ifndef ENCODER_QDEC
+#define ENCODER_QDEC
+
+#include <zephyr/device.h>
+
+/**
+ * @brief The encoder QDEC.
+*/
+typedef struct
+{
+  const struct device *dev;               /**< The QDEC sensor device. */
+  uint32_t countsPerRev;                  /**< The counts per revolution. */
+  int32_t lastCount;                      /**< The last read count. */
+} EncoderQdec;
+
+/**
+ * @brief   Initialize an encoder QDEC and read its start position.
+ *
+ * @param qdec    The encoder QDEC.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int encoderQdecInit(EncoderQdec *qdec);
+
+/**
+ * @brief   Read the counts since the last read. The counter wrap is handled
+ *          as long as less than half a revolution is counted between two
+ *          reads.
+ *
+ * @param qdec    The encoder QDEC.
+ * @param delta   The signed count delta.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int encoderQdecReadDelta(EncoderQdec *qdec, int32_t *delta);
+
+#endif    /* ENCODER_QDEC */
+
+/** @} */
@@ -0,0 +1,30 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      gpioPort.c
+ * @author    jbacon
+ * @date      2023-10-17
+ * @brief     GPIO Port Module
+ *
+ *            This file is the implementation of the GPIO port module.
+ *
+ * @ingroup  gpioPort
+ *
+ * @{
+ */
+
+#include <zephyr/kernel.h>
+
+#include "gpioPort.h"
+
+int gpioPortRead(const struct device *port, gpio_port_value_t *value)
+{
+  return gpio_port_get(port, value);
+}
+
+int gpioPortDisablePinIrq(const struct gpio_dt_spec *spec)
+{
+  return gpio_pin_interrupt_configure_dt(spec, GPIO_INT_DISABLE);
+}
+
+/** @} */
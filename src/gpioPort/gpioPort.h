@@ -0,0 +1,44 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      gpioPort.h
+ * @author    jbacon
+ * @date      2023-10-17
+ * @brief     GPIO Port Module
+ *
+ *            This file is the declaration of the GPIO port module. It
+ *            provides the port-wide GPIO accesses that are not covered by
+ *            the zephyr wrapper.
+ *
+ * @defgroup  gpioPort gpio-port
+ *
+ * @{
+ */
+
+#ifndef GPIO_PORT
+#define GPIO_PORT
+
+#include <zephyr/drivers/gpio.h>
+
+/**
+ * @brief   Read the logical input value of a whole GPIO port.
+ *
+ * @param port    The GPIO port device.
+ * @param value   The read port value.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int gpioPortRead(const struct device *port, gpio_port_value_t *value);
+
+/**
+ * @brief   Disable the interrupt of a GPIO pin.
+ *
+ * @param spec    The GPIO pin spec.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int gpioPortDisablePinIrq(const struct gpio_dt_spec *spec);
+
+#endif    /* GPIO_PORT */
+
+/** @} */
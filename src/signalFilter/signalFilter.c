@@ -0,0 +1,222 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      signalFilter.c
+ * @author    jbacon
+ * @date      2023-11-06
+ * @brief     Signal Filter Module
+ *
+ *            This file is the implementation of the signal filter module.
+ *
+ * @ingroup  signalFilter
+ *
+ * @{
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "signalFilter.h"
+
+/**
+ * @brief 2 pi, in thousandths, for the cutoff frequencies.
+*/
+#define SIGNAL_FILTER_TWO_PI_MILLI        6283
+
+/**
+ * @brief The One-Euro filtered value fraction bits.
+*/
+#define SIGNAL_FILTER_VALUE_FRAC_BITS     8
+
+/**
+ * @brief The smoothing factor fraction bits.
+*/
+#define SIGNAL_FILTER_ALPHA_FRAC_BITS     16
+
+/**
+ * @brief   Reject the spikes with the median of the last samples. The output
+ *          is the median of the samples seen until the window is full.
+ *
+ * @param filter    The signal filter.
+ * @param sample    The sample.
+ *
+ * @return  The median of the window.
+ */
+static uint32_t updateMedian(SignalFilter *filter, uint32_t sample)
+{
+  uint32_t sorted[SIGNAL_FILTER_MEDIAN_MAX];
+  uint32_t value;
+  int8_t j;
+
+  filter->window[filter->windowIdx] = sample;
+  filter->windowIdx = (filter->windowIdx + 1) % filter->config.medianSize;
+  if(filter->windowCount < filter->config.medianSize)
+    ++filter->windowCount;
+
+  /* insertion sort, the window is at most a few samples */
+  for(uint8_t i = 0; i < filter->windowCount; ++i)
+  {
+    value = filter->window[i];
+    j = i - 1;
+    while(j >= 0 && sorted[j] > value)
+    {
+      sorted[j + 1] = sorted[j];
+      --j;
+    }
+    sorted[j + 1] = value;
+  }
+
+  return sorted[filter->windowCount / 2];
+}
+
+/**
+ * @brief   Accumulate the samples for the oversampling. 4^n samples are
+ *          summed and shifted right by n, which gives n extra bits.
+ *
+ * @param filter    The signal filter.
+ * @param sample    The sample.
+ * @param decimated The decimated sample, only updated once 4^n samples are
+ *                  accumulated.
+ *
+ * @return  True if the decimated sample is updated, false otherwise.
+ */
+static bool updateOversampling(SignalFilter *filter, uint32_t sample,
+                               uint32_t *decimated)
+{
+  filter->decimSum += sample;
+  if(++filter->decimCount < BIT(2 * filter->config.oversampleBits))
+    return false;
+
+  *decimated = filter->decimSum >> filter->config.oversampleBits;
+  filter->decimSum = 0;
+  filter->decimCount = 0;
+
+  return true;
+}
+
+/**
+ * @brief   Compute the smoothing factor of a first order low pass filter,
+ *          1 / (1 + rate / (2 pi cutoff)).
+ *
+ * @param cutoffMilliHz   The cutoff frequency [mHz].
+ * @param rateHz          The sample rate [Hz].
+ *
+ * @return  The smoothing factor, with SIGNAL_FILTER_ALPHA_FRAC_BITS
+ *          fraction bits.
+ */
+static uint32_t getSmoothingFactor(uint32_t cutoffMilliHz, uint32_t rateHz)
+{
+  uint64_t omega = (uint64_t)cutoffMilliHz * SIGNAL_FILTER_TWO_PI_MILLI /
+    MSEC_PER_SEC;
+
+  return (uint32_t)((omega << SIGNAL_FILTER_ALPHA_FRAC_BITS) /
+    (omega + (uint64_t)rateHz * MSEC_PER_SEC));
+}
+
+/**
+ * @brief   Move a first order low pass filter state toward its input.
+ *
+ * @param state   The filter state.
+ * @param input   The filter input.
+ * @param alpha   The smoothing factor.
+ *
+ * @return  The new filter state.
+ */
+static inline int32_t smooth(int32_t state, int32_t input, uint32_t alpha)
+{
+  int64_t step = (int64_t)alpha * (input - state);
+
+  return state + (int32_t)((step + BIT(SIGNAL_FILTER_ALPHA_FRAC_BITS - 1)) >>
+    SIGNAL_FILTER_ALPHA_FRAC_BITS);
+}
+
+/**
+ * @brief   Smooth a sample with the One-Euro filter. The cutoff rises with
+ *          the filtered speed of the signal, so it is smooth while resting
+ *          and does not lag while moving fast.
+ *
+ * @param filter    The signal filter.
+ * @param sample    The sample.
+ *
+ * @return  The filtered sample.
+ */
+static uint32_t updateOneEuro(SignalFilter *filter, uint32_t sample)
+{
+  int32_t input = (int32_t)(sample << SIGNAL_FILTER_VALUE_FRAC_BITS);
+  int32_t deriv;
+  uint64_t cutoff;
+
+  if(!filter->primed)
+  {
+    filter->value = input;
+    filter->deriv = 0;
+    filter->primed = true;
+    return sample;
+  }
+
+  deriv = (int32_t)(((int64_t)(input - filter->value) * filter->rateHz) >>
+    SIGNAL_FILTER_VALUE_FRAC_BITS);
+  filter->deriv = smooth(filter->deriv, deriv, filter->derivAlpha);
+
+  cutoff = filter->config.minCutoffMilliHz +
+    (uint64_t)filter->config.betaMicro * ABS(filter->deriv) / 1000;
+  filter->value = smooth(filter->value, input,
+    getSmoothingFactor((uint32_t)MIN(cutoff, UINT32_MAX), filter->rateHz));
+
+  return (uint32_t)(filter->value + BIT(SIGNAL_FILTER_VALUE_FRAC_BITS - 1)) >>
+    SIGNAL_FILTER_VALUE_FRAC_BITS;
+}
+
+int signalFilterInit(SignalFilter *filter, const SignalFilterConfig *config)
+{
+  uint32_t rateHz;
+
+  if(config->sampleRateHz == 0 || config->medianSize == 0 ||
+     config->medianSize > SIGNAL_FILTER_MEDIAN_MAX ||
+     (config->medianSize & 1) == 0 ||
+     config->oversampleBits > SIGNAL_FILTER_OVERSAMPLE_MAX)
+    return -EINVAL;
+
+  rateHz = config->sampleRateHz >> (2 * config->oversampleBits);
+  if(config->minCutoffMilliHz > 0 &&
+     (config->derivCutoffMilliHz == 0 || rateHz == 0))
+    return -EINVAL;
+
+  memset(filter, 0, sizeof(*filter));
+  filter->config = *config;
+  filter->rateHz = rateHz;
+  if(config->minCutoffMilliHz > 0)
+    filter->derivAlpha = getSmoothingFactor(config->derivCutoffMilliHz,
+                                            rateHz);
+
+  return 0;
+}
+
+uint32_t signalFilterUpdate(SignalFilter *filter, uint32_t sample)
+{
+  uint32_t value = sample;
+
+  if(filter->config.medianSize > 1)
+    value = updateMedian(filter, value);
+
+  /* no zero output until the first decimation */
+  if(!filter->started)
+  {
+    filter->started = true;
+    filter->output = value << filter->config.oversampleBits;
+  }
+
+  if(filter->config.oversampleBits > 0 &&
+     !updateOversampling(filter, value, &value))
+    return filter->output;
+
+  if(filter->config.minCutoffMilliHz > 0)
+    value = updateOneEuro(filter, value);
+
+  filter->output = value;
+
+  return filter->output;
+}
+
+/** @} */
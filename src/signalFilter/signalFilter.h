@@ -0,0 +1,91 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      signalFilter.h
+ * @author    jbacon
+ * @date      2023-11-06
+ * @brief     Signal Filter Module
+ *
+ *            This file is the declaration of the signal filter module. A
+ *            signal filter smooths one analog channel through a median spike
+ *            rejector, a decimating oversampler and a One-Euro filter, each
+ *            stage being optional.
+ *
+ * @defgroup  signalFilter signal-filter
+ *
+ * @{
+ */
+
+#ifndef SIGNAL_FILTER
+#define SIGNAL_FILTER
+
+#include <zephyr/kernel.h>
+
+/**
+ * @brief The maximal median window size.
+*/
+#define SIGNAL_FILTER_MEDIAN_MAX          9
+
+/**
+ * @brief The maximal oversampling extra bits.
+*/
+#define SIGNAL_FILTER_OVERSAMPLE_MAX      4
+
+/**
+ * @brief The signal filter configuration.
+*/
+typedef struct
+{
+  uint32_t sampleRateHz;                  /**< The input sample rate [Hz]. */
+  uint8_t medianSize;                     /**< The median window size, odd, 1 disables the stage. */
+  uint8_t oversampleBits;                 /**< The oversampling extra bits, 4^n samples per output, 0 disables the stage. */
+  uint32_t minCutoffMilliHz;              /**< The One-Euro resting cutoff [mHz], 0 disables the stage. */
+  uint32_t betaMicro;                     /**< The One-Euro cutoff slope [uHz per unit/s]. */
+  uint32_t derivCutoffMilliHz;            /**< The One-Euro derivative cutoff [mHz]. */
+} SignalFilterConfig;
+
+/**
+ * @brief The signal filter.
+*/
+typedef struct
+{
+  SignalFilterConfig config;              /**< The filter configuration. */
+  uint32_t window[SIGNAL_FILTER_MEDIAN_MAX];  /**< The median window. */
+  uint8_t windowIdx;                      /**< The median window next index. */
+  uint8_t windowCount;                    /**< The median window sample count. */
+  uint32_t decimSum;                      /**< The oversampling accumulator. */
+  uint16_t decimCount;                    /**< The oversampling accumulated sample count. */
+  bool started;                           /**< The first sample seen flag. */
+  bool primed;                            /**< The One-Euro primed flag. */
+  uint32_t rateHz;                        /**< The One-Euro sample rate [Hz]. */
+  uint32_t derivAlpha;                    /**< The One-Euro derivative smoothing factor. */
+  int32_t value;                          /**< The One-Euro filtered value, with fraction bits. */
+  int32_t deriv;                          /**< The One-Euro filtered derivative [unit/s]. */
+  uint32_t output;                        /**< The filter output. */
+} SignalFilter;
+
+/**
+ * @brief   Initialize a signal filter.
+ *
+ * @param filter    The signal filter.
+ * @param config    The filter configuration.
+ *
+ * @return  0 if successful, the error code otherwise.
+ */
+int signalFilterInit(SignalFilter *filter, const SignalFilterConfig *config);
+
+/**
+ * @brief   Feed a sample to a signal filter. While oversampling, the output
+ *          only changes once every 4^n samples, the first sample being the
+ *          output until then.
+ *
+ * @param filter    The signal filter.
+ * @param sample    The sample.
+ *
+ * @return  The filter output, scaled by 2^n when oversampling.
+ */
+uint32_t signalFilterUpdate(SignalFilter *filter, uint32_t sample);
+
+#endif    /* SIGNAL_FILTER */
+
+/** @} */
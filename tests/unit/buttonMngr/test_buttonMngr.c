@@ -23,6 +23,11 @@
 #include "buttonMngr.h"
 #include "buttonMngr.c"
 
+#include "debounce.h"
+#include "gpioPort.h"
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+#include "encoderQdec.h"
+#endif
 #include "zephyrGpio.h"
 #include "zephyrThread.h"
 
@@ -35,7 +40,14 @@ FAKE_VALUE_FUNC(int, zephyrGpioEnableIrq, ZephyrGpio*, ZephyrGpioIrqTrig);
 FAKE_VALUE_FUNC(int, zephyrGpioSet, ZephyrGpio*);
 FAKE_VALUE_FUNC(int, zephyrGpioClear, ZephyrGpio*);
 FAKE_VALUE_FUNC(int, zephyrGpioRead, ZephyrGpio*);
-FAKE_VALUE_FUNC(uint32_t, zephyrThreadSleepMs, uint32_t);
+FAKE_VALUE_FUNC(int, gpioPortRead, const struct device*, gpio_port_value_t*);
+FAKE_VALUE_FUNC(int, gpioPortDisablePinIrq, const struct gpio_dt_spec*);
+FAKE_VALUE_FUNC(int, debounceInit, Debouncer*, DebounceAlgo, uint8_t, uint8_t);
+FAKE_VALUE_FUNC(uint32_t, debounceUpdate, Debouncer*, uint32_t);
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+FAKE_VALUE_FUNC(int, encoderQdecInit, EncoderQdec*);
+FAKE_VALUE_FUNC(int, encoderQdecReadDelta, EncoderQdec*, int32_t*);
+#endif
 FAKE_VOID_FUNC(zephyrThreadCreate, ZephyrThread*, char*, uint32_t,
                ZephyrTimeUnit);
 
@@ -55,6 +67,77 @@ FAKE_VOID_FUNC(zephyrThreadCreate, ZephyrThread*, char*, uint32_t,
 #define TOTAL_GPIO_COUNT      (TOTAL_ROW_COL_COUNT + BUTTON_SHIFTER_COUNT + \
                                BUTTON_ROCKER_COUNT + TOTAL_ENC_GPIO_CNT)
 
+/**
+ * @brief The test row port count.
+*/
+#define TEST_ROW_PORT_CNT     2
+
+/**
+ * @brief The test row ports.
+*/
+static const struct device testRowPorts[TEST_ROW_PORT_CNT];
+
+/**
+ * @brief The test row pins.
+*/
+static const gpio_pin_t testRowPins[BUTTON_ROW_COUNT] = {12, 13, 14, 15,
+                                                         6, 7, 8, 9};
+
+/**
+ * @brief The test encoder ports, one per signal.
+*/
+static const struct device testEncPorts[BUTTON_MNGR_ENC_SIG_CNT];
+
+/**
+ * @brief Get a callback structure pointer embedded in an encoder signal.
+*/
+#define TEST_ENC_CB(enc, sig)                                                 \
+  ((struct gpio_callback *)(encoders[enc].signals + (sig)))
+
+/**
+ * @brief The encoder port value returned by customEncPortRead.
+*/
+static gpio_port_value_t testPortValue;
+
+/**
+ * @brief The test scan cycle counter value.
+*/
+#define TEST_SCAN_CYCLE             0x12345678
+
+/**
+ * @brief The test change event queues.
+*/
+K_MSGQ_DEFINE(testEventQueue, sizeof(ButtonMngrEvent), 4, 4);
+K_MSGQ_DEFINE(testSmallQueue, sizeof(ButtonMngrEvent), 1, 4);
+K_MSGQ_DEFINE(testBadQueue, sizeof(uint32_t), 1, 4);
+
+/**
+ * @brief The gpioPortRead custom fake returning the test encoder port value.
+*/
+static int customEncPortRead(const struct device *port,
+                             gpio_port_value_t *value)
+{
+  *value = testPortValue;
+  return 0;
+}
+
+/**
+ * @brief The debounceUpdate custom fake passing the raw levels through.
+*/
+static uint32_t customDebounceUpdate(Debouncer *debouncer, uint32_t raw)
+{
+  return raw;
+}
+
+/**
+ * @brief The debounceUpdate custom fake pressing the left shifter and
+ *        passing the other raw levels through.
+*/
+static uint32_t customShifterPressed(Debouncer *debouncer, uint32_t raw)
+{
+  return debouncer == &shifterDebouncer ? BIT(0) : raw;
+}
+
 /**
  * @brief The test fixture.
 */
@@ -69,6 +152,39 @@ struct buttonMngr_suite_fixture
   WheelButtonState buttonStates[BUTTON_COUNT];              /**< The button states. */
 };
 
+/**
+ * @brief The input button states set before each test (odd buttons pressed).
+*/
+#define TEST_INPUT_BITS             0xaaaaaaaa
+
+/**
+ * @brief The encoder button states set before each test (odd buttons pressed).
+*/
+#define TEST_ENCODER_BITS           0xaaaa
+
+/**
+ * @brief   Get all the button states without clearing the encoder buttons.
+ *
+ * @return  The packed button states.
+ */
+static WheelButtonBits getTestButtonBits(void)
+{
+  return (WheelButtonBits)(uint32_t)atomic_get(&inputBits) |
+    ((WheelButtonBits)(uint32_t)atomic_get(&encoderBits) << TC_INC_IDX);
+}
+
+/**
+ * @brief   Get a button state from the packed button states.
+ *
+ * @param idx   The button index.
+ *
+ * @return  The button state.
+ */
+static WheelButtonState getTestButtonState(WheelButtonIdx idx)
+{
+  return (WheelButtonState)((getTestButtonBits() >> idx) & 1);
+}
+
 static void *buttonMngrSuiteSetup(void)
 {
   struct buttonMngr_suite_fixture *fixture =
@@ -120,16 +236,85 @@ static void buttonMngrCaseSetup(void *f)
       fixture->buttonStates[i] = BUTTON_PRESSED;
   }
 
+  atomic_set(&inputBits, TEST_INPUT_BITS);
+  atomic_set(&encoderBits, TEST_ENCODER_BITS);
+  for(uint8_t i = 0; i < BUTTON_ENC_BUTTON_COUNT; ++i)
+  {
+    atomic_clear(encPressCounts + i);
+    eventCursor.pressCounts[i] = 0;
+  }
+  atomic_clear(&subscriberCount);
+  atomic_clear(&encActivity);
+  notifiedInputBits = 0;
   for(uint8_t i = 0; i < BUTTON_COUNT; ++i)
+    edgeCycles[i] = 0;
+  for(uint8_t i = 0; i < TC_INC_IDX; ++i)
+    rawEdgeCycles[i] = 0;
+  for(uint8_t i = 0; i < ATOMIC_BITMAP_SIZE(BUTTON_COUNT); ++i)
+    atomic_clear(edgeValid + i);
+  shifterRaw = 0;
+  rockerRaw = 0;
+  rawInputBits = packInputBits(TEST_INPUT_BITS, 0, 0);
+  k_msgq_purge(&testEventQueue);
+  k_msgq_purge(&testSmallQueue);
+
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
   {
-    if(i % 2)
-      buttonStates[i] = BUTTON_PRESSED;
-    else
-      buttonStates[i] = BUTTON_DEPRESSED;
+    encoders[i].mode = ENCODER_MODE_1;
+    encoders[i].state = 0;
+    encoders[i].stepsPerDetent = 1;
+    encoders[i].subSteps = 0;
+    encoders[i].polled = false;
+    encoders[i].disabled = false;
+    for(uint8_t j = 0; j < BUTTON_MNGR_ENC_SIG_CNT; ++j)
+    {
+      encoders[i].signals[j].dev.port = testEncPorts + j;
+      encoders[i].signals[j].dev.pin = BUTTON_MNGR_ENC_SIG_CNT * i + j;
+    }
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+    encoders[i].qdec.dev = NULL;
+#endif
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+    encoders[i].stepCycle = 0;
+    encoders[i].stepPeriod = 0;
+#endif
   }
 
-  for(uint8_t i = 0; i < RIGHT_ENC_IDX + 1; ++i)
-    encModes[i] = ENCODER_MODE_1;
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
+  {
+    atomic_clear(encSteps + i);
+    atomic_clear(encNoise + i);
+  }
+
+  for(uint8_t i = 0; i < BUTTON_ROW_COUNT; ++i)
+  {
+    rows[i].dev.port = testRowPorts + i / (BUTTON_ROW_COUNT / TEST_ROW_PORT_CNT);
+    rows[i].dev.pin = testRowPins[i];
+  }
+
+  /* on the EXTI lines left free by the rows */
+  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT; ++i)
+  {
+    shifters[i].dev.port = testRowPorts;
+    shifters[i].dev.pin = i;
+  }
+
+  for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT; ++i)
+  {
+    rockers[i].dev.port = testRowPorts;
+    rockers[i].dev.pin = BUTTON_SHIFTER_COUNT + i;
+  }
+
+#ifdef CONFIG_BUTTON_MNGR_ANY_KEY_SCAN
+  /* a key held, the full scan runs */
+  matrixRaw = TEST_INPUT_BITS;
+#endif
+  settleCycles = 0;
+  atomic_clear(&settleCalibRequest);
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+  k_sem_reset(&wakeupSem);
+  atomic_clear(&idleFlag);
+#endif
 
   RESET_FAKE(zephyrGpioInit);
   RESET_FAKE(zephyrGpioAddIrqCallback);
@@ -137,13 +322,26 @@ static void buttonMngrCaseSetup(void *f)
   RESET_FAKE(zephyrGpioSet);
   RESET_FAKE(zephyrGpioClear);
   RESET_FAKE(zephyrGpioRead);
-  RESET_FAKE(zephyrThreadSleepMs);
+  RESET_FAKE(gpioPortRead);
+  RESET_FAKE(gpioPortDisablePinIrq);
+  RESET_FAKE(debounceInit);
+  RESET_FAKE(debounceUpdate);
+  debounceUpdate_fake.custom_fake = customDebounceUpdate;
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+  RESET_FAKE(encoderQdecInit);
+  RESET_FAKE(encoderQdecReadDelta);
+#endif
   RESET_FAKE(zephyrThreadCreate);
+
+  buttonMngrResetScanStats();
 }
 
 ZTEST_SUITE(buttonMngr_suite, NULL, buttonMngrSuiteSetup, buttonMngrCaseSetup,
   NULL, buttonMngrSuiteTeardown);
 
+#define ENC_SIG_PORT_TEST_CNT               4
+#define ENC_MODE_TEST_CNT                   2
+
 #define ENC_NO_CHANGE_STATE_TEST_CNT        8
 /**
  * @test  processEncoderIrq must read the current encoder gpio state, determine
@@ -162,13 +360,14 @@ ZTEST(buttonMngr_suite, test_processEncoderIrq_NoChangeState)
   for(uint8_t i = 0; i < ENC_NO_CHANGE_STATE_TEST_CNT; ++i)
   {
     SET_RETURN_SEQ(zephyrGpioRead, gpioStates[i], BUTTON_MNGR_ENC_SIG_CNT);
+    encoders[LEFT_ENC_IDX].state = prevStates[i];
 
     zassert_equal(ENCODER_NO_CHANGE,
-      processEncoderIrq(leftEncoder, prevStates + i));
+      processEncoderIrq(encoders + LEFT_ENC_IDX));
     zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(leftEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(leftEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(states[i], prevStates[i]);
+    zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioRead_fake.arg0_history[0]);
+    zassert_equal(encoders[LEFT_ENC_IDX].signals + 1, zephyrGpioRead_fake.arg0_history[1]);
+    zassert_equal(states[i], encoders[LEFT_ENC_IDX].state);
 
     RESET_FAKE(zephyrGpioRead);
   }
@@ -190,13 +389,14 @@ ZTEST(buttonMngr_suite, test_processEncoderIrq_IncrementState)
   for(uint8_t i = 0; i < ENC_CHANGE_STATE_TEST_CNT; ++i)
   {
     SET_RETURN_SEQ(zephyrGpioRead, gpioStates[i], BUTTON_MNGR_ENC_SIG_CNT);
+    encoders[LEFT_ENC_IDX].state = prevStates[i];
 
     zassert_equal(ENCODER_INCREMENT,
-      processEncoderIrq(leftEncoder, prevStates + i));
+      processEncoderIrq(encoders + LEFT_ENC_IDX));
     zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(leftEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(leftEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(states[i], prevStates[i]);
+    zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioRead_fake.arg0_history[0]);
+    zassert_equal(encoders[LEFT_ENC_IDX].signals + 1, zephyrGpioRead_fake.arg0_history[1]);
+    zassert_equal(states[i], encoders[LEFT_ENC_IDX].state);
 
     RESET_FAKE(zephyrGpioRead);
   }
@@ -217,13 +417,14 @@ ZTEST(buttonMngr_suite, test_processEncoderIrq_DecrementState)
   for(uint8_t i = 0; i < ENC_CHANGE_STATE_TEST_CNT; ++i)
   {
     SET_RETURN_SEQ(zephyrGpioRead, gpioStates[i], BUTTON_MNGR_ENC_SIG_CNT);
+    encoders[LEFT_ENC_IDX].state = prevStates[i];
 
     zassert_equal(ENCODER_DECREMENT,
-      processEncoderIrq(leftEncoder, prevStates + i));
+      processEncoderIrq(encoders + LEFT_ENC_IDX));
     zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(leftEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(leftEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(states[i], prevStates[i]);
+    zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioRead_fake.arg0_history[0]);
+    zassert_equal(encoders[LEFT_ENC_IDX].signals + 1, zephyrGpioRead_fake.arg0_history[1]);
+    zassert_equal(states[i], encoders[LEFT_ENC_IDX].state);
 
     RESET_FAKE(zephyrGpioRead);
   }
@@ -231,79 +432,104 @@ ZTEST(buttonMngr_suite, test_processEncoderIrq_DecrementState)
 
 #define ENC_STATE_BUTTONS_TEST_CNT          3
 /**
- * @test  leftEncoderIrq must process the left encoder signals and set the
- *        encoder M1 increment/decrement/ no change buttons states when the
- *        encoder is in mode M1.
+ * @test  readEncoderSignals must sample both signals in a single port read
+ *        when they share the same port.
 */
-ZTEST(buttonMngr_suite, test_leftEncoderIrq_ButtonUpdateStateM1)
+ZTEST(buttonMngr_suite, test_readEncoderSignals_SamePort)
 {
-  uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
-  int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
-  WheelButtonState expectedStates[ENC_STATE_BUTTONS_TEST_CNT][2] =
-    {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
-     {BUTTON_PRESSED, BUTTON_DEPRESSED},
-     {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  int successRet = 0;
+  int sigA;
+  int sigB;
+  gpio_port_value_t portValues[ENC_SIG_PORT_TEST_CNT] = {0x0000, 0x0100,
+                                                         0x0200, 0x0300};
+  EncoderDesc *enc = encoders + TC_ENC_IDX;
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
-  {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+  enc->signals[1].dev.port = enc->signals[0].dev.port;
+  enc->signals[0].dev.pin = 9;
+  enc->signals[1].dev.pin = 8;
 
-    buttonStates[LEFT_ENC_M1_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[LEFT_ENC_M1_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[LEFT_ENC_IDX] = prevStates[i];
+  for(uint8_t i = 0; i < ENC_SIG_PORT_TEST_CNT; ++i)
+  {
+    testPortValue = portValues[i] | 0x00ff;
+    gpioPortRead_fake.custom_fake = customEncPortRead;
 
-    leftEncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(leftEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(leftEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[LEFT_ENC_M1_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[LEFT_ENC_M1_DEC_IDX]);
+    zassert_equal(successRet, readEncoderSignals(enc, &sigA, &sigB));
+    zassert_equal(1, gpioPortRead_fake.call_count);
+    zassert_equal(enc->signals[0].dev.port, gpioPortRead_fake.arg0_val);
+    zassert_equal(0, zephyrGpioRead_fake.call_count);
+    zassert_equal((i >> 1) & 1, sigA);
+    zassert_equal(i & 1, sigB);
 
-    RESET_FAKE(zephyrGpioRead);
+    RESET_FAKE(gpioPortRead);
   }
 }
 
 /**
- * @test  leftEncoderIrq must process the left encoder signals and set the
- *        encoder M2 increment/decrement/ no change buttons states when the
- *        encoder is in mode M2.
+ * @test  readEncoderSignals must return the error code when the signals
+ *        cannot be read.
 */
-ZTEST(buttonMngr_suite, test_leftEncoderIrq_ButtonUpdateStateM2)
+ZTEST(buttonMngr_suite, test_readEncoderSignals_ReadFail)
 {
-  uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
-  int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
-  WheelButtonState expectedStates[ENC_STATE_BUTTONS_TEST_CNT][2] =
-    {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
-     {BUTTON_PRESSED, BUTTON_DEPRESSED},
-     {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  int failRet = -EIO;
+  int successRet = 0;
+  int sigA;
+  int sigB;
+  int readRetVals[BUTTON_MNGR_ENC_SIG_CNT] = {successRet, failRet};
+  EncoderDesc *enc = encoders + TC_ENC_IDX;
 
-  encModes[LEFT_ENC_IDX] = ENCODER_MODE_2;
+  zephyrGpioRead_fake.return_val = failRet;
+  zassert_equal(failRet, readEncoderSignals(enc, &sigA, &sigB));
+  zassert_equal(1, zephyrGpioRead_fake.call_count);
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
-  {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+  RESET_FAKE(zephyrGpioRead);
+  SET_RETURN_SEQ(zephyrGpioRead, readRetVals, BUTTON_MNGR_ENC_SIG_CNT);
+  zassert_equal(failRet, readEncoderSignals(enc, &sigA, &sigB));
+  zassert_equal(2, zephyrGpioRead_fake.call_count);
+
+  enc->signals[1].dev.port = enc->signals[0].dev.port;
+  gpioPortRead_fake.return_val = failRet;
+  zassert_equal(failRet, readEncoderSignals(enc, &sigA, &sigB));
+  zassert_equal(1, gpioPortRead_fake.call_count);
+}
 
-    buttonStates[LEFT_ENC_M2_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[LEFT_ENC_M2_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[LEFT_ENC_IDX] = prevStates[i];
+/**
+ * @test  processEncoderIrq must keep the encoder state and return the no
+ *        change state when the signals cannot be read.
+*/
+ZTEST(buttonMngr_suite, test_processEncoderIrq_ReadFail)
+{
+  encoders[LEFT_ENC_IDX].state = 1;
+  zephyrGpioRead_fake.return_val = -EIO;
 
-    leftEncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(leftEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(leftEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[LEFT_ENC_M2_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[LEFT_ENC_M2_DEC_IDX]);
+  zassert_equal(ENCODER_NO_CHANGE, processEncoderIrq(encoders + LEFT_ENC_IDX));
+  zassert_equal(1, encoders[LEFT_ENC_IDX].state);
+}
 
-    RESET_FAKE(zephyrGpioRead);
+/**
+ * @test  getEncoderFromCallback must return the descriptor embedding the
+ *        callback, or NULL when the callback is not an encoder one.
+*/
+ZTEST(buttonMngr_suite, test_getEncoderFromCallback_Resolve)
+{
+  struct gpio_callback otherCb;
+
+  for(uint8_t enc = 0; enc < ENCODER_COUNT; ++enc)
+  {
+    for(uint8_t sig = 0; sig < BUTTON_MNGR_ENC_SIG_CNT; ++sig)
+      zassert_equal(encoders + enc,
+        getEncoderFromCallback(TEST_ENC_CB(enc, sig)));
   }
+
+  zassert_is_null(getEncoderFromCallback(&otherCb));
+  zassert_is_null(getEncoderFromCallback(NULL));
 }
 
 /**
- * @test  rightEncoderIrq must process the right encoder signals and set the
- *        encoder M1 increment/decrement/no change buttons states when the
- *        encoder is in mode M1.
+ * @test  encoderIrq must process the signals of the encoder owning the
+ *        callback and set its increment/decrement button state for the
+ *        current encoder mode.
 */
-ZTEST(buttonMngr_suite, test_rightEncoderIrq_ButtonUpdateStateM1)
+ZTEST(buttonMngr_suite, test_encoderIrq_ButtonUpdateState)
 {
   uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
   int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
@@ -311,390 +537,1563 @@ ZTEST(buttonMngr_suite, test_rightEncoderIrq_ButtonUpdateStateM1)
     {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
      {BUTTON_PRESSED, BUTTON_DEPRESSED},
      {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  WheelEncoderMode modes[ENC_MODE_TEST_CNT] = {ENCODER_MODE_1, ENCODER_MODE_2};
+  EncoderDesc *enc;
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
+  for(uint8_t e = 0; e < ENCODER_COUNT; ++e)
   {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+    enc = encoders + e;
+    for(uint8_t m = 0; m < ENC_MODE_TEST_CNT; ++m)
+    {
+      /* only the left and right encoders have modes */
+      if(e > RIGHT_ENC_IDX && modes[m] != ENCODER_MODE_1)
+        continue;
+
+      enc->mode = modes[m];
+      for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
+      {
+        SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+
+        atomic_clear(&encoderBits);
+        enc->state = prevStates[i];
+
+        encoderIrq(NULL, TEST_ENC_CB(e, i % BUTTON_MNGR_ENC_SIG_CNT), 0);
+        zassert_equal(2, zephyrGpioRead_fake.call_count);
+        zassert_equal(enc->signals, zephyrGpioRead_fake.arg0_history[0]);
+        zassert_equal(enc->signals + 1, zephyrGpioRead_fake.arg0_history[1]);
+        zassert_equal(expectedStates[i][0],
+          getTestButtonState(enc->incIdx + modes[m]));
+        zassert_equal(expectedStates[i][1],
+          getTestButtonState(enc->decIdx + modes[m]));
+
+        RESET_FAKE(zephyrGpioRead);
+      }
+    }
+  }
+}
+
+/**
+ * @test  encoderIrq must ignore a callback that is not an encoder one.
+*/
+ZTEST(buttonMngr_suite, test_encoderIrq_UnknownCallback)
+{
+  struct gpio_callback otherCb;
 
-    buttonStates[BB_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[BB_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[RIGHT_ENC_IDX] = prevStates[i];
+  atomic_clear(&encoderBits);
 
-    rightEncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(rightEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(rightEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[BB_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[BB_DEC_IDX]);
+  encoderIrq(NULL, &otherCb, 0);
+  zassert_equal(0, zephyrGpioRead_fake.call_count);
+  zassert_equal(0, gpioPortRead_fake.call_count);
+  zassert_equal(0, atomic_get(&encoderBits));
+}
+
+#define ENC_STEP_COUNT_TEST_CNT     5
+/**
+ * @test  The encoder IRQ must count every step, so that consecutive steps
+ *        do not collapse into a single button press.
+*/
+ZTEST(buttonMngr_suite, test_encoderIrq_CountSteps)
+{
+  int incStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
+  int decStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_SET};
+
+  for(uint8_t enc = 0; enc < ENCODER_COUNT; ++enc)
+  {
+    for(uint8_t i = 0; i < ENC_STEP_COUNT_TEST_CNT; ++i)
+    {
+      SET_RETURN_SEQ(zephyrGpioRead, incStates, BUTTON_MNGR_ENC_SIG_CNT);
+      encoders[enc].state = 1;
+      encoderIrq(NULL, TEST_ENC_CB(enc, 0), 0);
+      RESET_FAKE(zephyrGpioRead);
+    }
+
+    zassert_equal(ENC_STEP_COUNT_TEST_CNT, atomic_get(encSteps + enc));
 
+    SET_RETURN_SEQ(zephyrGpioRead, decStates, BUTTON_MNGR_ENC_SIG_CNT);
+    encoders[enc].state = 0;
+    encoderIrq(NULL, TEST_ENC_CB(enc, 1), 0);
     RESET_FAKE(zephyrGpioRead);
+
+    zassert_equal(ENC_STEP_COUNT_TEST_CNT - 1, atomic_get(encSteps + enc));
   }
 }
 
+#define ENC_DETENT_STEP_CNT         4
 /**
- * @test  rightEncoderIrq must process the right encoder signals and set the
- *        encoder M2 increment/decrement/no change buttons states when the
- *        encoder is in mode M2.
+ * @test  The encoder IRQ must accumulate the quadrature steps and count a
+ *        single step per detent, once the detent is complete.
 */
-ZTEST(buttonMngr_suite, test_rightEncoderIrq_ButtonUpdateStateM2)
+ZTEST(buttonMngr_suite, test_encoderIrq_StepsPerDetent)
 {
-  uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
-  int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
-  WheelButtonState expectedStates[ENC_STATE_BUTTONS_TEST_CNT][2] =
-    {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
-     {BUTTON_PRESSED, BUTTON_DEPRESSED},
-     {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  int detentStates[ENC_DETENT_STEP_CNT][BUTTON_MNGR_ENC_SIG_CNT] =
+    {{GPIO_CLR, GPIO_SET}, {GPIO_CLR, GPIO_CLR},
+     {GPIO_SET, GPIO_CLR}, {GPIO_SET, GPIO_SET}};
 
-  encModes[RIGHT_ENC_IDX] = ENCODER_MODE_2;
+  encoders[RIGHT_ENC_IDX].stepsPerDetent = ENC_DETENT_STEP_CNT;
+  encoders[RIGHT_ENC_IDX].state = 3;
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
+  for(uint8_t i = 0; i < ENC_DETENT_STEP_CNT; ++i)
   {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+    SET_RETURN_SEQ(zephyrGpioRead, detentStates[i], BUTTON_MNGR_ENC_SIG_CNT);
+    encoderIrq(NULL, TEST_ENC_CB(RIGHT_ENC_IDX, 0), 0);
+    RESET_FAKE(zephyrGpioRead);
+
+    if(i < ENC_DETENT_STEP_CNT - 1)
+      zassert_equal(0, atomic_get(encSteps + RIGHT_ENC_IDX));
+  }
 
-    buttonStates[RIGHT_ENC_M2_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[RIGHT_ENC_M2_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[RIGHT_ENC_IDX] = prevStates[i];
+  zassert_equal(1, atomic_get(encSteps + RIGHT_ENC_IDX));
+  zassert_equal(0, encoders[RIGHT_ENC_IDX].subSteps);
+  zassert_equal(0, atomic_get(encNoise + RIGHT_ENC_IDX));
+}
 
-    rightEncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(rightEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(rightEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[RIGHT_ENC_M2_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[RIGHT_ENC_M2_DEC_IDX]);
+#ifdef CONFIG_BUTTON_MNGR_ENC_REST_RESYNC
+/**
+ * @test  The encoder IRQ must resynchronize on the rest state, dropping a
+ *        partial detent up to its half and counting a larger one.
+*/
+ZTEST(buttonMngr_suite, test_encoderIrq_RestResync)
+{
+  int firstStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_SET, GPIO_CLR};
+  int restStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_SET, GPIO_SET};
 
-    RESET_FAKE(zephyrGpioRead);
-  }
+  encoders[TC_ENC_IDX].stepsPerDetent = ENC_DETENT_STEP_CNT;
+
+  /* started between two detents, half a detent to the rest state */
+  SET_RETURN_SEQ(zephyrGpioRead, firstStates, BUTTON_MNGR_ENC_SIG_CNT);
+  encoderIrq(NULL, TEST_ENC_CB(TC_ENC_IDX, 0), 0);
+  RESET_FAKE(zephyrGpioRead);
+  SET_RETURN_SEQ(zephyrGpioRead, restStates, BUTTON_MNGR_ENC_SIG_CNT);
+  encoderIrq(NULL, TEST_ENC_CB(TC_ENC_IDX, 0), 0);
+  RESET_FAKE(zephyrGpioRead);
+
+  zassert_equal(0, atomic_get(encSteps + TC_ENC_IDX));
+  zassert_equal(0, encoders[TC_ENC_IDX].subSteps);
+
+  /* missed transition, three quarters of a detent to the rest state */
+  encoders[TC_ENC_IDX].state = 2;
+  encoders[TC_ENC_IDX].subSteps = 2;
+  SET_RETURN_SEQ(zephyrGpioRead, restStates, BUTTON_MNGR_ENC_SIG_CNT);
+  encoderIrq(NULL, TEST_ENC_CB(TC_ENC_IDX, 0), 0);
+  RESET_FAKE(zephyrGpioRead);
+
+  zassert_equal(1, atomic_get(encSteps + TC_ENC_IDX));
+  zassert_equal(0, encoders[TC_ENC_IDX].subSteps);
 }
+#endif
 
 /**
- * @test  tcEncoderIrq must process the let encoder signals and set the
- *        encoder increment/decrement/no change buttons states.
+ * @test  The encoder IRQ must count the invalid transitions as noise,
+ *        without counting any step.
 */
-ZTEST(buttonMngr_suite, test_tcEncoderIrq_ButtonUpdateState)
+ZTEST(buttonMngr_suite, test_encoderIrq_CountNoise)
 {
-  uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
-  int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
-  WheelButtonState expectedStates[ENC_STATE_BUTTONS_TEST_CNT][2] =
-    {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
-     {BUTTON_PRESSED, BUTTON_DEPRESSED},
-     {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  int states[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_SET, GPIO_SET};
+  uint32_t noise;
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
-  {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+  encoders[ABS_ENC_IDX].stepsPerDetent = ENC_DETENT_STEP_CNT;
 
-    buttonStates[TC_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[TC_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[TC_ENC_IDX] = prevStates[i];
+  SET_RETURN_SEQ(zephyrGpioRead, states, BUTTON_MNGR_ENC_SIG_CNT);
+  encoderIrq(NULL, TEST_ENC_CB(ABS_ENC_IDX, 0), 0);
 
-    tcEncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(tcEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(tcEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[TC_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[TC_DEC_IDX]);
+  zassert_equal(0, atomic_get(encSteps + ABS_ENC_IDX));
+  zassert_equal(0, buttonMngrGetEncoderNoise(ABS_ENC_IDX, &noise));
+  zassert_equal(1, noise);
+  zassert_equal(-EINVAL, buttonMngrGetEncoderNoise(ENCODER_COUNT, &noise));
+}
 
-    RESET_FAKE(zephyrGpioRead);
+#define ENC_ACCUMULATE_TEST_CNT     4
+/**
+ * @test  accumulateEncoderSteps must carry the partial detents over to the
+ *        next steps.
+*/
+ZTEST(buttonMngr_suite, test_accumulateEncoderSteps_CarryPartial)
+{
+  int32_t steps[ENC_ACCUMULATE_TEST_CNT] = {3, 6, -2, -9};
+  int32_t expectedDetents[ENC_ACCUMULATE_TEST_CNT] = {0, 2, 0, -2};
+  int32_t expectedSubSteps[ENC_ACCUMULATE_TEST_CNT] = {3, 1, -1, -2};
+
+  encoders[MAP_ENC_IDX].stepsPerDetent = ENC_DETENT_STEP_CNT;
+
+  for(uint8_t i = 0; i < ENC_ACCUMULATE_TEST_CNT; ++i)
+  {
+    zassert_equal(expectedDetents[i],
+      accumulateEncoderSteps(encoders + MAP_ENC_IDX, steps[i], false));
+    zassert_equal(expectedSubSteps[i], encoders[MAP_ENC_IDX].subSteps);
   }
 }
 
+#define ENC_ADD_STEPS_TEST_CNT      4
 /**
- * @test  tc1EncoderIrq must process the let encoder signals and set the
- *        encoder M1 increment/decrement/no change buttons states.
+ * @test  addEncoderSteps must add the steps to the encoder counter and press
+ *        the increment or decrement button of the current mode.
 */
-ZTEST(buttonMngr_suite, test_tc1EncoderIrq_ButtonUpdateState)
+ZTEST(buttonMngr_suite, test_addEncoderSteps_CountAndPress)
 {
-  uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
-  int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
-  WheelButtonState expectedStates[ENC_STATE_BUTTONS_TEST_CNT][2] =
-    {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
-     {BUTTON_PRESSED, BUTTON_DEPRESSED},
-     {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  int32_t steps[ENC_ADD_STEPS_TEST_CNT] = {0, 3, -5, 1};
+  int32_t expectedCounts[ENC_ADD_STEPS_TEST_CNT] = {0, 3, -2, -1};
+  WheelButtonBits expectedBits[ENC_ADD_STEPS_TEST_CNT] =
+    {0, BIT64(BB_INC_IDX + ENCODER_MODE_2),
+     BIT64(BB_DEC_IDX + ENCODER_MODE_2), BIT64(BB_INC_IDX + ENCODER_MODE_2)};
+
+  encoders[RIGHT_ENC_IDX].mode = ENCODER_MODE_2;
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
+  for(uint8_t i = 0; i < ENC_ADD_STEPS_TEST_CNT; ++i)
   {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+    atomic_clear(&encoderBits);
+    addEncoderSteps(encoders + RIGHT_ENC_IDX, steps[i]);
+    zassert_equal(expectedCounts[i], atomic_get(encSteps + RIGHT_ENC_IDX));
+    zassert_equal(expectedBits[i],
+      getTestButtonBits() & ~BIT64_MASK(TC_INC_IDX));
+  }
+}
 
-    buttonStates[TC1_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[TC1_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[TC1_ENC_IDX] = prevStates[i];
+#ifdef CONFIG_BUTTON_MNGR_ENC_QDEC
+/**
+ * @brief The encoderQdecReadDelta custom fake deltas, one per encoder.
+*/
+static int32_t testQdecDeltas[ENCODER_COUNT];
 
-    tc1EncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(tc1Encoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(tc1Encoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[TC1_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[TC1_DEC_IDX]);
+/**
+ * @brief The encoderQdecReadDelta custom fake.
+*/
+static int customQdecReadDelta(EncoderQdec *qdec, int32_t *delta)
+{
+  EncoderDesc *enc = CONTAINER_OF(qdec, EncoderDesc, qdec);
 
-    RESET_FAKE(zephyrGpioRead);
-  }
+  *delta = testQdecDeltas[enc - encoders];
+  return 0;
 }
 
 /**
- * @test  absEncoderIrq must process the let encoder signals and set the
- *        encoder M1 increment/decrement/no change buttons states.
+ * @test  readQdecEncoders must only read the hardware decoded encoders, add
+ *        their counts and report if any of them moved.
 */
-ZTEST(buttonMngr_suite, test_absEncoderIrq_ButtonUpdateState)
+ZTEST(buttonMngr_suite, test_readQdecEncoders_AddCounts)
 {
-  uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
-  int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
-  WheelButtonState expectedStates[ENC_STATE_BUTTONS_TEST_CNT][2] =
-    {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
-     {BUTTON_PRESSED, BUTTON_DEPRESSED},
-     {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  encoders[LEFT_ENC_IDX].qdec.dev = testEncPorts;
+  encoders[RIGHT_ENC_IDX].qdec.dev = testEncPorts;
+  encoderQdecReadDelta_fake.custom_fake = customQdecReadDelta;
+
+  testQdecDeltas[LEFT_ENC_IDX] = 0;
+  testQdecDeltas[RIGHT_ENC_IDX] = 0;
+  zassert_false(readQdecEncoders());
+  zassert_equal(2, encoderQdecReadDelta_fake.call_count);
+  zassert_equal(&encoders[LEFT_ENC_IDX].qdec,
+    encoderQdecReadDelta_fake.arg0_history[0]);
+  zassert_equal(&encoders[RIGHT_ENC_IDX].qdec,
+    encoderQdecReadDelta_fake.arg0_history[1]);
+
+  testQdecDeltas[LEFT_ENC_IDX] = -2;
+  testQdecDeltas[RIGHT_ENC_IDX] = 7;
+  zassert_true(readQdecEncoders());
+  zassert_equal(-2, atomic_get(encSteps + LEFT_ENC_IDX));
+  zassert_equal(7, atomic_get(encSteps + RIGHT_ENC_IDX));
+}
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
-  {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+/**
+ * @test  readQdecEncoders must skip an encoder whose decoder cannot be read.
+*/
+ZTEST(buttonMngr_suite, test_readQdecEncoders_ReadFail)
+{
+  encoders[TC_ENC_IDX].qdec.dev = testEncPorts;
+  encoderQdecReadDelta_fake.return_val = -EIO;
 
-    buttonStates[ABS_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[ABS_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[ABS_ENC_IDX] = prevStates[i];
+  zassert_false(readQdecEncoders());
+  zassert_equal(1, encoderQdecReadDelta_fake.call_count);
+  zassert_equal(0, atomic_get(encSteps + TC_ENC_IDX));
+}
 
-    absEncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(absEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(absEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[ABS_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[ABS_DEC_IDX]);
+/**
+ * @test  initEncoder must initialize the hardware decoder of an encoder that
+ *        has one instead of its signal GPIOs.
+*/
+ZTEST(buttonMngr_suite, test_initEncoder_Qdec)
+{
+  int failRet = -ENODEV;
+  encoders[ABS_ENC_IDX].qdec.dev = testEncPorts;
+  encoderQdecInit_fake.return_val = failRet;
+
+  zassert_equal(failRet, initEncoder(encoders + ABS_ENC_IDX));
+  zassert_equal(1, encoderQdecInit_fake.call_count);
+  zassert_equal(&encoders[ABS_ENC_IDX].qdec, encoderQdecInit_fake.arg0_val);
+  zassert_equal(0, zephyrGpioInit_fake.call_count);
+  zassert_equal(0, zephyrGpioAddIrqCallback_fake.call_count);
+}
+#endif
 
-    RESET_FAKE(zephyrGpioRead);
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
+/**
+ * @brief The row masks (bit n is row n) read by the readButtonMatrix tests.
+*/
+static const uint8_t testColRowMasks[BUTTON_COL_COUNT] = {0x01, 0x82,
+                                                          0x5a, 0x24};
+
+/**
+ * @brief The gpioPortRead custom fake returning the port value of the
+ *        current column row mask.
+*/
+static int customGpioPortRead(const struct device *port,
+                              gpio_port_value_t *value)
+{
+  uint8_t col = (gpioPortRead_fake.call_count - 1) / TEST_ROW_PORT_CNT;
+
+  /* bit 0 is not a row pin and must be masked out */
+  *value = BIT(0);
+  for(uint8_t row = 0; row < BUTTON_ROW_COUNT; ++row)
+  {
+    if(rows[row].dev.port == port && (testColRowMasks[col] & BIT(row)))
+      *value |= BIT(testRowPins[row]);
   }
+
+  return 0;
 }
 
 /**
- * @test  mapEncoderIrq must process the let encoder signals and set the
- *        encoder M1 increment/decrement/no change buttons states.
+ * @test  initMatrixPortGroups must group the rows by port and build the pin
+ *        mask of each port group.
 */
-ZTEST(buttonMngr_suite, test_mapEncoderIrq_ButtonUpdateState)
+ZTEST(buttonMngr_suite, test_initMatrixPortGroups_GroupRowsByPort)
 {
-  uint8_t prevStates[ENC_STATE_BUTTONS_TEST_CNT] = {0, 1, 2};
-  int gpioStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
-  WheelButtonState expectedStates[ENC_STATE_BUTTONS_TEST_CNT][2] =
-    {{BUTTON_DEPRESSED, BUTTON_DEPRESSED},
-     {BUTTON_PRESSED, BUTTON_DEPRESSED},
-     {BUTTON_DEPRESSED, BUTTON_PRESSED}};
+  gpio_port_pins_t expectedMasks[TEST_ROW_PORT_CNT] = {0xf000, 0x03c0};
+
+  initMatrixPortGroups();
 
-  for(uint8_t i = 0; i < ENC_STATE_BUTTONS_TEST_CNT; ++i)
+  zassert_equal(TEST_ROW_PORT_CNT, rowPortGroupCount);
+  for(uint8_t i = 0; i < TEST_ROW_PORT_CNT; ++i)
   {
-    SET_RETURN_SEQ(zephyrGpioRead, gpioStates, BUTTON_MNGR_ENC_SIG_CNT);
+    zassert_equal(testRowPorts + i, rowPortGroups[i].port);
+    zassert_equal(expectedMasks[i], rowPortGroups[i].mask);
+  }
 
-    buttonStates[MAP_INC_IDX] = BUTTON_DEPRESSED;
-    buttonStates[MAP_DEC_IDX] = BUTTON_DEPRESSED;
-    encSigStates[MAP_ENC_IDX] = prevStates[i];
+  for(uint8_t i = 0; i < BUTTON_ROW_COUNT; ++i)
+    zassert_equal(i / (BUTTON_ROW_COUNT / TEST_ROW_PORT_CNT),
+      rowPortGroupIdx[i]);
+}
 
-    mapEncoderIrq(NULL, NULL, 0);
-    zassert_equal(2, zephyrGpioRead_fake.call_count);
-    zassert_equal(mapEncoder, zephyrGpioRead_fake.arg0_history[0]);
-    zassert_equal(mapEncoder + 1, zephyrGpioRead_fake.arg0_history[1]);
-    zassert_equal(expectedStates[i][0], buttonStates[MAP_INC_IDX]);
-    zassert_equal(expectedStates[i][1], buttonStates[MAP_DEC_IDX]);
+/**
+ * @test  readButtonMatrix must return the error code if any of the set column
+ *        operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonMatrix_SetColumnFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  uint32_t states = 0;
 
-    RESET_FAKE(zephyrGpioRead);
+  initMatrixPortGroups();
+  gpioPortRead_fake.custom_fake = customGpioPortRead;
+
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+  {
+    if(i > 0)
+      fixture->colSetRetVals[i - 1] = successRet;
+    fixture->colSetRetVals[i] = failRet;
+    SET_RETURN_SEQ(zephyrGpioSet, fixture->colSetRetVals, i + 1);
+
+    zassert_equal(failRet, readButtonMatrix(&states));
+    zassert_equal(i + 1, zephyrGpioSet_fake.call_count);
+    zassert_equal(i * TEST_ROW_PORT_CNT, gpioPortRead_fake.call_count);
+    for(uint8_t j = 0; j < i; ++j)
+      zassert_equal(columns + j, zephyrGpioSet_fake.arg0_history[j]);
+    RESET_FAKE(zephyrGpioSet);
+    RESET_FAKE(gpioPortRead);
+    gpioPortRead_fake.custom_fake = customGpioPortRead;
+  }
+}
+
+/**
+ * @test  readButtonMatrix must return the error code and clear the column
+ *        if any of the row port read operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonMatrix_ReadPortFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  int readRetVals[TEST_ROW_PORT_CNT];
+  uint32_t states = 0;
+
+  initMatrixPortGroups();
+
+  for(uint8_t i = 0; i < TEST_ROW_PORT_CNT; ++i)
+  {
+    for(uint8_t j = 0; j < TEST_ROW_PORT_CNT; ++j)
+      readRetVals[j] = j == i ? failRet : successRet;
+    SET_RETURN_SEQ(gpioPortRead, readRetVals, TEST_ROW_PORT_CNT);
+
+    zassert_equal(failRet, readButtonMatrix(&states));
+    zassert_equal(i + 1, gpioPortRead_fake.call_count);
+    for(uint8_t j = 0; j <= i; ++j)
+      zassert_equal(testRowPorts + j, gpioPortRead_fake.arg0_history[j]);
+    zassert_equal(1, zephyrGpioClear_fake.call_count);
+    zassert_equal(columns, zephyrGpioClear_fake.arg0_val);
+    RESET_FAKE(gpioPortRead);
+    RESET_FAKE(zephyrGpioClear);
+  }
+}
+
+/**
+ * @test  readButtonMatrix must return the error code if any of the clear column
+ *        operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonMatrix_ClearColumnFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  uint32_t states = 0;
+
+  initMatrixPortGroups();
+  gpioPortRead_fake.custom_fake = customGpioPortRead;
+
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+  {
+    if(i > 0)
+      fixture->colClearRetVals[i - 1] = successRet;
+    fixture->colClearRetVals[i] = failRet;
+    SET_RETURN_SEQ(zephyrGpioClear, fixture->colClearRetVals, i + 1);
+
+    zassert_equal(failRet, readButtonMatrix(&states));
+    zassert_equal(i + 1, zephyrGpioClear_fake.call_count);
+    for(uint8_t j = 0; j <= i; ++j)
+      zassert_equal(columns + j, zephyrGpioClear_fake.arg0_history[j]);
+    RESET_FAKE(zephyrGpioClear);
+    RESET_FAKE(gpioPortRead);
+    gpioPortRead_fake.custom_fake = customGpioPortRead;
+  }
+}
+
+/**
+ * @test  readButtonMatrix must return the success code, read each row port
+ *        once per column and update the button states when all operations
+ *        succeed.
+*/
+ZTEST(buttonMngr_suite, test_readButtonMatrix_Success)
+{
+  int successRet = 0;
+  uint32_t states = 0;
+
+  initMatrixPortGroups();
+  gpioPortRead_fake.custom_fake = customGpioPortRead;
+
+  zassert_equal(successRet, readButtonMatrix(&states));
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
+  zassert_equal(BUTTON_COL_COUNT * TEST_ROW_PORT_CNT,
+    gpioPortRead_fake.call_count);
+  zassert_equal(0, zephyrGpioRead_fake.call_count);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+  for(uint8_t col = 0; col < BUTTON_COL_COUNT; ++col)
+  {
+    zassert_equal(columns + col, zephyrGpioSet_fake.arg0_history[col]);
+    zassert_equal(columns + col, zephyrGpioClear_fake.arg0_history[col]);
+    for(uint8_t row = 0; row < BUTTON_ROW_COUNT; ++row)
+      zassert_equal((testColRowMasks[col] >> row) & 1,
+        (states >> (BUTTON_ROW_COUNT * col + row)) & 1);
+  }
+
+  zassert_equal(1, debounceUpdate_fake.call_count);
+  zassert_equal(&matrixDebouncer, debounceUpdate_fake.arg0_val);
+  zassert_equal(0x245a8201, debounceUpdate_fake.arg1_val);
+}
+
+/**
+ * @test  readButtonMatrix must update the button states with the debounced
+ *        states rather than the raw levels.
+*/
+ZTEST(buttonMngr_suite, test_readButtonMatrix_DebouncedStates)
+{
+  int successRet = 0;
+  uint32_t debounced = 0x0f0f00f0;
+  uint32_t states = 0;
+
+  initMatrixPortGroups();
+  gpioPortRead_fake.custom_fake = customGpioPortRead;
+  debounceUpdate_fake.custom_fake = NULL;
+  debounceUpdate_fake.return_val = debounced;
+
+  zassert_equal(successRet, readButtonMatrix(&states));
+  zassert_equal(debounced, states);
+}
+
+#ifdef CONFIG_BUTTON_MNGR_ANY_KEY_SCAN
+/**
+ * @test  readButtonMatrix must only drive all the columns and read each row
+ *        port once while no key is held and none is pressed.
+*/
+ZTEST(buttonMngr_suite, test_readButtonMatrix_AnyKeyIdle)
+{
+  int successRet = 0;
+  uint32_t states = 0;
+
+  matrixRaw = 0;
+  initMatrixPortGroups();
+  testPortValue = BIT(0);
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+
+  zassert_equal(successRet, readButtonMatrix(&states));
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
+  zassert_equal(TEST_ROW_PORT_CNT, gpioPortRead_fake.call_count);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+  zassert_equal(1, debounceUpdate_fake.call_count);
+  zassert_equal(0, debounceUpdate_fake.arg1_val);
+  zassert_equal(0, matrixRaw);
+}
+
+/**
+ * @test  readButtonMatrix must run the full scan once the any-key check is
+ *        positive.
+*/
+ZTEST(buttonMngr_suite, test_readButtonMatrix_AnyKeyPressed)
+{
+  int successRet = 0;
+  uint32_t states = 0;
+
+  matrixRaw = 0;
+  initMatrixPortGroups();
+  /* a single row per column, not a ghosting rectangle */
+  testPortValue = BIT(testRowPins[4]);
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+
+  zassert_equal(successRet, readButtonMatrix(&states));
+  zassert_equal(2 * BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
+  zassert_equal(2 + BUTTON_COL_COUNT * TEST_ROW_PORT_CNT,
+    gpioPortRead_fake.call_count);
+  zassert_equal(2 * BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+  zassert_equal(0x10101010, debounceUpdate_fake.arg1_val);
+  zassert_equal(0x10101010, matrixRaw);
+}
+
+/**
+ * @test  readButtonMatrix must return the error code and release all the
+ *        columns when the any-key check read fails.
+*/
+ZTEST(buttonMngr_suite, test_readButtonMatrix_AnyKeyReadFail)
+{
+  int failRet = -EIO;
+  uint32_t states = 0;
+
+  matrixRaw = 0;
+  initMatrixPortGroups();
+  gpioPortRead_fake.return_val = failRet;
+
+  zassert_equal(failRet, readButtonMatrix(&states));
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+  zassert_equal(0, debounceUpdate_fake.call_count);
+}
+#endif
+#else
+/**
+ * @test  readButtonMatrix must return the error code if any of the set column
+ *        operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonMatrix_SetColumnFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  uint32_t states = 0;
+
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+  {
+    if(i > 0)
+      fixture->colSetRetVals[i - 1] = successRet;
+    fixture->colSetRetVals[i] = failRet;
+    SET_RETURN_SEQ(zephyrGpioSet, fixture->colSetRetVals, i + 1);
+
+    zassert_equal(failRet, readButtonMatrix(&states));
+    zassert_equal(i + 1, zephyrGpioSet_fake.call_count);
+    for(uint8_t j = 0; j > i; ++j)
+      zassert_equal(columns + j, zephyrGpioSet_fake.arg0_history[j]);
+    RESET_FAKE(zephyrGpioSet);
+  }
+}
+
+/**
+ * @test  readButtonMatrix must return the error code if any of the clear column
+ *        operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonMatrix_ClearColumnFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  uint32_t states = 0;
+
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+  {
+    SET_RETURN_SEQ(zephyrGpioSet, fixture->colSetRetVals, i + 1);
+
+    if(i > 0)
+      fixture->colClearRetVals[i - 1] = successRet;
+    fixture->colClearRetVals[i] = failRet;
+    SET_RETURN_SEQ(zephyrGpioClear, fixture->colClearRetVals, i + 1);
+
+    zassert_equal(failRet, readButtonMatrix(&states));
+    zassert_equal(i + 1, zephyrGpioClear_fake.call_count);
+    for(uint8_t j = 0; j > i; ++j)
+      zassert_equal(columns + j, zephyrGpioClear_fake.arg0_history[j]);
+    RESET_FAKE(zephyrGpioClear);
+  }
+}
+
+/**
+ * @test  readButtonMatrix must return the error code and clear the column
+ *        if any of the read row operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonMatrix_ReadRowFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  uint32_t states = 0;
+
+  for(uint8_t i = 0; i < BUTTON_ROW_COUNT; ++i)
+  {
+    zephyrGpioSet_fake.return_val = successRet;
+
+    if(i > 0)
+      fixture->readRetVals[i - 1] = successRet;
+    fixture->readRetVals[i] = failRet;
+    SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, i + 1);
+
+    zephyrGpioClear_fake.return_val = successRet;
+
+    zassert_equal(failRet, readButtonMatrix(&states));
+    zassert_equal(i + 1, zephyrGpioRead_fake.call_count);
+    zassert_equal(1, zephyrGpioClear_fake.call_count);
+    zassert_equal(columns, zephyrGpioClear_fake.arg0_val);
+    for(uint8_t j = 0; j > i; ++j)
+      zassert_equal(rows + j, zephyrGpioRead_fake.arg0_history[j]);
+    RESET_FAKE(zephyrGpioRead);
+    RESET_FAKE(zephyrGpioClear);
+  }
+}
+
+/**
+ * @test  readButtonMatrix must return the success code and update the button
+ *        states when all operations succeeds.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonMatrix_Success)
+{
+  int successRet = 0;
+  uint32_t states = 0;
+  int readRetVals[BUTTON_MNGR_MATRIX_KEY_CNT];
+
+  /* one key per column, no ghosting rectangle */
+  for(uint8_t i = 0; i < BUTTON_MNGR_MATRIX_KEY_CNT; ++i)
+    readRetVals[i] = i % BUTTON_ROW_COUNT == i / BUTTON_ROW_COUNT ?
+      BUTTON_PRESSED : BUTTON_DEPRESSED;
+
+  SET_RETURN_SEQ(zephyrGpioSet, fixture->colSetRetVals, BUTTON_COL_COUNT);
+  SET_RETURN_SEQ(zephyrGpioRead, readRetVals, BUTTON_MNGR_MATRIX_KEY_CNT);
+  SET_RETURN_SEQ(zephyrGpioClear, fixture->colClearRetVals, BUTTON_COL_COUNT);
+
+  zassert_equal(successRet, readButtonMatrix(&states));
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
+  zassert_equal(BUTTON_ROW_COUNT * BUTTON_COL_COUNT,
+    zephyrGpioRead_fake.call_count);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+  {
+    zassert_equal(columns + i, zephyrGpioSet_fake.arg0_history[i]);
+    zassert_equal(columns + i, zephyrGpioClear_fake.arg0_history[i]);
+  }
+
+  for(uint8_t i = 0; i < BUTTON_ROW_COUNT * BUTTON_COL_COUNT; ++i)
+  {
+    zassert_equal(rows + (i % 8), zephyrGpioRead_fake.arg0_history[i]);
+    zassert_equal(readRetVals[i], (states >> i) & 1);
+  }
+}
+#endif
+
+/**
+ * @test  checkSettleTime must apply the settle time and stop at the first scan
+ *        not matching the reference scan.
+*/
+ZTEST(buttonMngr_suite, test_checkSettleTime_Unstable)
+{
+  int successRet = 0;
+  bool stable = true;
+
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
+  initMatrixPortGroups();
+  testPortValue = 0;
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+#endif
+
+  zassert_equal(successRet, checkSettleTime(BUTTON_MNGR_SETTLE_STEP_CYCLES,
+                                            0x00000001, &stable));
+  zassert_false(stable);
+  zassert_equal(BUTTON_MNGR_SETTLE_STEP_CYCLES, settleCycles);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
+}
+
+/**
+ * @test  calibrateSettleTime must keep one calibration step above the first
+ *        stable settle time.
+*/
+ZTEST(buttonMngr_suite, test_calibrateSettleTime_Stable)
+{
+  int successRet = 0;
+
+  /* all the keys held */
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
+  initMatrixPortGroups();
+  testPortValue = 0xffff;
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+#else
+  zephyrGpioRead_fake.return_val = 1;
+#endif
+
+  zassert_equal(successRet, calibrateSettleTime());
+  zassert_equal(MIN(BUTTON_MNGR_SETTLE_STEP_CYCLES,
+                    BUTTON_MNGR_SETTLE_MAX_CYCLES), settleCycles);
+  zassert_equal(BUTTON_COL_COUNT * (1 + CONFIG_BUTTON_MNGR_SETTLE_CALIB_SCANS),
+    zephyrGpioSet_fake.call_count);
+  zassert_equal(0, debounceUpdate_fake.call_count);
+}
+
+/**
+ * @test  calibrateSettleTime must return the no data error code and keep the
+ *        current settle time when no key is held.
+*/
+ZTEST(buttonMngr_suite, test_calibrateSettleTime_NoKeyHeld)
+{
+  int failRet = -ENODATA;
+
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
+  initMatrixPortGroups();
+  testPortValue = 0;
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+#endif
+  settleCycles = BUTTON_MNGR_SETTLE_STEP_CYCLES;
+
+  zassert_equal(failRet, calibrateSettleTime());
+  zassert_equal(BUTTON_MNGR_SETTLE_STEP_CYCLES, settleCycles);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
+}
+
+/**
+ * @test  calibrateSettleTime must return the error code and fall back to the
+ *        maximal settle time when the matrix scan fails.
+*/
+ZTEST(buttonMngr_suite, test_calibrateSettleTime_ReadFail)
+{
+  int failRet = -EIO;
+
+#ifdef CONFIG_BUTTON_MNGR_MATRIX_PORT_SCAN
+  initMatrixPortGroups();
+#endif
+  gpioPortRead_fake.return_val = failRet;
+  zephyrGpioRead_fake.return_val = failRet;
+
+  zassert_equal(failRet, calibrateSettleTime());
+  zassert_equal(BUTTON_MNGR_SETTLE_MAX_CYCLES, settleCycles);
+}
+
+/**
+ * @test  buttonMngrGetSettleTime must return the column settle time in
+ *        nanoseconds.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrGetSettleTime_Convert)
+{
+  settleCycles = BUTTON_MNGR_SETTLE_MAX_CYCLES;
+
+  zassert_equal(k_cyc_to_ns_near32(BUTTON_MNGR_SETTLE_MAX_CYCLES),
+    buttonMngrGetSettleTime());
+}
+
+#define GHOST_KEYS_TEST_CNT             5
+/**
+ * @test  getGhostKeys must return the keys of the columns sharing two or
+ *        more active rows.
+*/
+ZTEST(buttonMngr_suite, test_getGhostKeys_Rectangles)
+{
+  uint32_t raws[GHOST_KEYS_TEST_CNT] = {0x00000000, 0x01010101, 0x00030001,
+                                        0x00030003, 0x06000006};
+  uint32_t expectedKeys[GHOST_KEYS_TEST_CNT] = {0x00000000, 0x00000000,
+                                                0x00000000, 0x00ff00ff,
+                                                0xff0000ff};
+
+  for(uint8_t i = 0; i < GHOST_KEYS_TEST_CNT; ++i)
+    zassert_equal(expectedKeys[i], getGhostKeys(raws[i]));
+}
+
+/**
+ * @test  filterGhostKeys must count the ghosting scans and keep the last raw
+ *        states of the ambiguous columns if suppressed.
+*/
+ZTEST(buttonMngr_suite, test_filterGhostKeys_CountAndSuppress)
+{
+  ButtonMngrScanStats stats;
+#ifdef CONFIG_BUTTON_MNGR_GHOST_SUPPRESS
+  uint32_t expected = 0x12020402;
+#else
+  uint32_t expected = 0x12030403;
+#endif
+
+  matrixRaw = 0x34020002;
+
+  zassert_equal(0x00000402, filterGhostKeys(0x00000402));
+  zassert_equal(expected, filterGhostKeys(0x12030403));
+
+  buttonMngrGetScanStats(&stats);
+  zassert_equal(1, stats.ghostCount);
+
+  buttonMngrResetScanStats();
+  buttonMngrGetScanStats(&stats);
+  zassert_equal(0, stats.ghostCount);
+}
+
+/**
+ * @test  readButtonShifters must return the error code if any of the read
+ *        operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonShifters_ReadFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  uint32_t states = 0;
+
+  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT; ++i)
+  {
+    if(i > 0)
+      fixture->readRetVals[i - 1] = successRet;
+    fixture->readRetVals[i] = failRet;
+    SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, i + 1);
+
+    zassert_equal(failRet, readButtonShifters(&states));
+    zassert_equal(i + 1, zephyrGpioRead_fake.call_count);
+    for(uint8_t j = 0; j > i; ++j)
+      zassert_equal(shifters + j, zephyrGpioRead_fake.arg0_history[j]);
+    RESET_FAKE(zephyrGpioRead);
+  }
+}
+
+/**
+ * @test  readButtonShifters must return the success code and update the
+ *        shifters button states when all operations succeed.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonShifters_Success)
+{
+  int successRet = 0;
+  uint32_t states = 0;
+
+  SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, BUTTON_SHIFTER_COUNT);
+
+  zassert_equal(successRet, readButtonShifters(&states));
+  zassert_equal(BUTTON_SHIFTER_COUNT, zephyrGpioRead_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT; ++i)
+  {
+    zassert_equal(shifters + i, zephyrGpioRead_fake.arg0_history[i]);
+    zassert_equal(fixture->readRetVals[i], (states >> i) & 1);
+  }
+  zassert_equal(1, debounceUpdate_fake.call_count);
+  zassert_equal(&shifterDebouncer, debounceUpdate_fake.arg0_val);
+}
+
+/**
+ * @test  readButtonRockers must return the error code if any of the read
+ *        operation fails.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonRockers_ReadFail)
+{
+  int failRet = -EIO;
+  int successRet = 0;
+  uint32_t states = 0;
+
+  for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT; ++i)
+  {
+    if(i > 0)
+      fixture->readRetVals[i - 1] = successRet;
+    fixture->readRetVals[i] = failRet;
+    SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, i + 1);
+
+    zassert_equal(failRet, readButtonRockers(&states));
+    zassert_equal(i + 1, zephyrGpioRead_fake.call_count);
+    for(uint8_t j = 0; j > i; ++j)
+      zassert_equal(rockers + j, zephyrGpioRead_fake.arg0_history[j]);
+    RESET_FAKE(zephyrGpioRead);
+  }
+}
+
+/**
+ * @test  readButtonRockers must return the success code and update the
+ *        rockers button states when all operations succeed.
+*/
+ZTEST_F(buttonMngr_suite, test_readButtonRockers_Success)
+{
+  int successRet = 0;
+  uint32_t states = 0;
+
+  SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, BUTTON_ROCKER_COUNT);
+
+  zassert_equal(successRet, readButtonRockers(&states));
+  zassert_equal(BUTTON_ROCKER_COUNT, zephyrGpioRead_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT; ++i)
+  {
+    zassert_equal(rockers + i, zephyrGpioRead_fake.arg0_history[i]);
+    zassert_equal(fixture->readRetVals[i], (states >> i) & 1);
+  }
+  zassert_equal(1, debounceUpdate_fake.call_count);
+  zassert_equal(&rockerDebouncer, debounceUpdate_fake.arg0_val);
+}
+
+/**
+ * @test  publishInputStates must store the matrix states with the shifter and
+ *        rocker states overriding their matrix slots.
+*/
+ZTEST(buttonMngr_suite, test_publishInputStates_OverrideMatrixSlots)
+{
+  uint32_t matrix = 0xffffffff;
+
+  publishInputStates(matrix, 0, 0);
+  zassert_equal(matrix & ~(BUTTON_MNGR_SHIFTER_MASK | BUTTON_MNGR_ROCKER_MASK),
+    (uint32_t)atomic_get(&inputBits));
+
+  publishInputStates(0, BIT(1), BIT(0));
+  zassert_equal(BIT(RIGHT_SHIFTER_IDX) | BIT(LEFT_ROCKER_IDX),
+    (uint32_t)atomic_get(&inputBits));
+
+  publishInputStates(0, 0xff, 0xff);
+  zassert_equal(BUTTON_MNGR_SHIFTER_MASK | BUTTON_MNGR_ROCKER_MASK,
+    (uint32_t)atomic_get(&inputBits));
+}
+
+/**
+ * @test  publishInputStates must stamp the changed buttons only, with the
+ *        scan that first saw their raw level, and the other buttons must
+ *        have no edge.
+*/
+ZTEST(buttonMngr_suite, test_publishInputStates_StampEdges)
+{
+  uint32_t cycle;
+
+  rawEdgeCycles[RIGHT_TOP_0_IDX] = TEST_SCAN_CYCLE;
+  publishInputStates(TEST_INPUT_BITS ^ BIT(RIGHT_TOP_0_IDX), BIT(1), BIT(1));
+
+  for(uint8_t i = 0; i < BUTTON_COUNT; ++i)
+  {
+    if(i == RIGHT_TOP_0_IDX)
+    {
+      zassert_equal(0, buttonMngrGetEdgeCycle(i, &cycle));
+      zassert_equal(TEST_SCAN_CYCLE, cycle);
+    }
+    else
+      zassert_equal(-ENODATA, buttonMngrGetEdgeCycle(i, &cycle));
+  }
+}
+
+/**
+ * @test  stampRawEdges must stamp the raw changes of a scan, before
+ *        debouncing, and publishInputStates must keep that stamp when the
+ *        debounced state changes scans later.
+*/
+ZTEST(buttonMngr_suite, test_stampRawEdges_StampRawChanges)
+{
+  uint32_t cycle;
+
+  matrixRaw = TEST_INPUT_BITS ^ BIT(RIGHT_TOP_0_IDX);
+  stampRawEdges(TEST_SCAN_CYCLE);
+  zassert_equal(TEST_SCAN_CYCLE, rawEdgeCycles[RIGHT_TOP_0_IDX]);
+
+  /* the raw level holds while debouncing */
+  stampRawEdges(TEST_SCAN_CYCLE + 1);
+  shifterRaw = BIT(0);
+  stampRawEdges(TEST_SCAN_CYCLE + 2);
+  for(uint8_t i = 0; i < TC_INC_IDX; ++i)
+  {
+    if(i == RIGHT_TOP_0_IDX)
+      zassert_equal(TEST_SCAN_CYCLE, rawEdgeCycles[i]);
+    else if(i == LEFT_SHIFTER_IDX)
+      zassert_equal(TEST_SCAN_CYCLE + 2, rawEdgeCycles[i]);
+    else
+      zassert_equal(0, rawEdgeCycles[i]);
+  }
+
+  publishInputStates(matrixRaw, 0, 0);
+  zassert_equal(0, buttonMngrGetEdgeCycle(RIGHT_TOP_0_IDX, &cycle));
+  zassert_equal(TEST_SCAN_CYCLE, cycle);
+}
+
+/**
+ * @test  pressEncoderButton must stamp the edge of the encoder button and
+ *        buttonMngrGetEdgeCycle must reject an invalid button.
+*/
+ZTEST(buttonMngr_suite, test_pressEncoderButton_StampEdge)
+{
+  uint32_t before;
+  uint32_t cycle;
+
+  zassert_equal(-ENODATA, buttonMngrGetEdgeCycle(TC1_DEC_IDX, &cycle));
+
+  before = k_cycle_get_32();
+  pressEncoderButton(TC1_DEC_IDX);
+
+  zassert_equal(0, buttonMngrGetEdgeCycle(TC1_DEC_IDX, &cycle));
+  zassert_true(cycle - before <= k_cycle_get_32() - before);
+  zassert_equal(-EINVAL, buttonMngrGetEdgeCycle(BUTTON_COUNT, &cycle));
+}
+
+#define DEBOUNCER_COUNT                 3
+/**
+ * @test  initDebouncers must initialize the matrix, shifter and rocker
+ *        debouncers with their configured algorithm and stop at the first
+ *        failure.
+*/
+ZTEST(buttonMngr_suite, test_initDebouncers_InitAll)
+{
+  int successRet = 0;
+  int failRet = -EINVAL;
+  int retVals[DEBOUNCER_COUNT];
+  Debouncer *expectedDebouncers[DEBOUNCER_COUNT] = {&matrixDebouncer,
+                                                   &shifterDebouncer,
+                                                   &rockerDebouncer};
+  DebounceAlgo expectedAlgos[DEBOUNCER_COUNT] =
+    {CONFIG_BUTTON_MNGR_MATRIX_DEBOUNCE_ALGO,
+     CONFIG_BUTTON_MNGR_SHIFTER_DEBOUNCE_ALGO,
+     CONFIG_BUTTON_MNGR_ROCKER_DEBOUNCE_ALGO};
+  uint8_t expectedKeyCounts[DEBOUNCER_COUNT] = {BUTTON_MNGR_MATRIX_KEY_CNT,
+                                                BUTTON_SHIFTER_COUNT,
+                                                BUTTON_ROCKER_COUNT};
+
+  zassert_equal(successRet, initDebouncers());
+  zassert_equal(DEBOUNCER_COUNT, debounceInit_fake.call_count);
+  for(uint8_t i = 0; i < DEBOUNCER_COUNT; ++i)
+  {
+    zassert_equal(expectedDebouncers[i], debounceInit_fake.arg0_history[i]);
+    zassert_equal(expectedAlgos[i], debounceInit_fake.arg1_history[i]);
+    zassert_equal(expectedKeyCounts[i], debounceInit_fake.arg2_history[i]);
+    zassert_true(debounceInit_fake.arg3_history[i] > 0);
+  }
+
+  for(uint8_t i = 0; i < DEBOUNCER_COUNT; ++i)
+  {
+    RESET_FAKE(debounceInit);
+    for(uint8_t j = 0; j < DEBOUNCER_COUNT; ++j)
+      retVals[j] = j == i ? failRet : successRet;
+    SET_RETURN_SEQ(debounceInit, retVals, DEBOUNCER_COUNT);
+
+    zassert_equal(failRet, initDebouncers());
+    zassert_equal(i + 1, debounceInit_fake.call_count);
+  }
+}
+
+#ifdef CONFIG_BUTTON_MNGR_IDLE_WAKEUP
+/**
+ * @brief   Poll all the test encoders, their signals sharing the EXTI lines
+ *          of the wake-up sources.
+ */
+static void pollTestEncoders(void)
+{
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
+    encoders[i].polled = true;
+}
+
+/**
+ * @test  wakeupIrq must give the wake-up semaphore.
+*/
+ZTEST(buttonMngr_suite, test_wakeupIrq_GiveSemaphore)
+{
+  k_sem_reset(&wakeupSem);
+
+  wakeupIrq(NULL, NULL, 0);
+
+  zassert_equal(1, k_sem_count_get(&wakeupSem));
+}
+
+/**
+ * @test  isAnyButtonPressed must return true only when a matrix, shifter or
+ *        rocker button is pressed, ignoring the encoder buttons.
+*/
+ZTEST(buttonMngr_suite, test_isAnyButtonPressed_PressedState)
+{
+  atomic_set(&inputBits, 0);
+  atomic_set(&encoderBits, BIT_MASK(BUTTON_COUNT - TC_INC_IDX));
+
+  zassert_false(isAnyButtonPressed());
+
+  for(uint8_t i = 0; i < TC_INC_IDX; ++i)
+  {
+    atomic_set(&inputBits, BIT(i));
+    zassert_true(isAnyButtonPressed());
+  }
+}
+
+/**
+ * @test  initWakeupSources must add the wake-up callback to the rows, the
+ *        shifters and the rockers and make the idle mode available.
+*/
+ZTEST(buttonMngr_suite, test_initWakeupSources_Success)
+{
+  ZephyrGpio *expectedGpio;
+
+  pollTestEncoders();
+  wakeupIrqAvailable = false;
+
+  initWakeupSources();
+
+  zassert_true(wakeupIrqAvailable);
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT,
+    zephyrGpioAddIrqCallback_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT; ++i)
+  {
+    if(i < BUTTON_ROW_COUNT)
+      expectedGpio = rows + i;
+    else if(i < BUTTON_ROW_COUNT + BUTTON_SHIFTER_COUNT)
+      expectedGpio = shifters + (i - BUTTON_ROW_COUNT);
+    else
+      expectedGpio = rockers + (i - BUTTON_ROW_COUNT - BUTTON_SHIFTER_COUNT);
+
+    zassert_equal(expectedGpio, wakeupSources[i]);
+    zassert_equal(expectedGpio, zephyrGpioAddIrqCallback_fake.arg0_history[i]);
+    zassert_equal(wakeupIrq, zephyrGpioAddIrqCallback_fake.arg1_history[i]);
+  }
+}
+
+/**
+ * @test  initWakeupSources must leave the idle mode unavailable when adding
+ *        a wake-up callback fails.
+*/
+ZTEST(buttonMngr_suite, test_initWakeupSources_AddCallbackFail)
+{
+  pollTestEncoders();
+  wakeupIrqAvailable = true;
+  zephyrGpioAddIrqCallback_fake.return_val = -EBUSY;
+
+  initWakeupSources();
+
+  zassert_false(wakeupIrqAvailable);
+  zassert_equal(1, zephyrGpioAddIrqCallback_fake.call_count);
+}
+
+/**
+ * @test  initWakeupSources must leave the wake-up interrupts unavailable,
+ *        without adding any callback, when a wake-up source shares its EXTI
+ *        line with another source or with an encoder using its IRQs.
+*/
+ZTEST(buttonMngr_suite, test_initWakeupSources_SharedLine)
+{
+  gpio_pin_t rockerPin = rockers[0].dev.pin;
+
+  /* same pin number as a row on another port */
+  pollTestEncoders();
+  rockers[0].dev.pin = rows[BUTTON_ROW_COUNT - 1].dev.pin;
+  wakeupIrqAvailable = true;
+
+  initWakeupSources();
+
+  zassert_false(wakeupIrqAvailable);
+  zassert_equal(0, zephyrGpioAddIrqCallback_fake.call_count);
+
+  /* same pin number as an encoder signal */
+  rockers[0].dev.pin = rockerPin;
+  encoders[RIGHT_ENC_IDX].polled = false;
+  encoders[RIGHT_ENC_IDX].signals[0].dev.pin = rockerPin;
+  wakeupIrqAvailable = true;
+
+  initWakeupSources();
+
+  zassert_false(wakeupIrqAvailable);
+  zassert_equal(0, zephyrGpioAddIrqCallback_fake.call_count);
+
+  /* a polled encoder does not hold its lines */
+  encoders[RIGHT_ENC_IDX].polled = true;
+
+  initWakeupSources();
+
+  zassert_true(wakeupIrqAvailable);
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT,
+    zephyrGpioAddIrqCallback_fake.call_count);
+}
+
+/**
+ * @test  enterIdleMode must drive all the columns, arm all the wake-up
+ *        interrupts and leave the semaphore untaken when no input is active.
+*/
+ZTEST(buttonMngr_suite, test_enterIdleMode_Success)
+{
+  int successRet = 0;
+
+  initWakeupSources();
+  zephyrGpioRead_fake.return_val = GPIO_CLR;
+
+  zassert_equal(successRet, enterIdleMode());
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+    zassert_equal(columns + i, zephyrGpioSet_fake.arg0_history[i]);
+
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT, zephyrGpioEnableIrq_fake.call_count);
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT, zephyrGpioRead_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT; ++i)
+  {
+    zassert_equal(wakeupSources[i], zephyrGpioEnableIrq_fake.arg0_history[i]);
+    zassert_equal(GPIO_IRQ_EDGE_BOTH,
+      zephyrGpioEnableIrq_fake.arg1_history[i]);
+    zassert_equal(wakeupSources[i], zephyrGpioRead_fake.arg0_history[i]);
+  }
+
+  zassert_equal(0, zephyrGpioClear_fake.call_count);
+  zassert_equal(0, k_sem_count_get(&wakeupSem));
+}
+
+/**
+ * @test  enterIdleMode must give the wake-up semaphore when an input is
+ *        already active once the interrupts are armed.
+*/
+ZTEST(buttonMngr_suite, test_enterIdleMode_InputActive)
+{
+  int successRet = 0;
+  int readRetVals[2] = {GPIO_CLR, GPIO_SET};
+
+  initWakeupSources();
+  SET_RETURN_SEQ(zephyrGpioRead, readRetVals, 2);
+
+  zassert_equal(successRet, enterIdleMode());
+  zassert_equal(2, zephyrGpioRead_fake.call_count);
+  zassert_equal(1, k_sem_count_get(&wakeupSem));
+}
+
+/**
+ * @test  enterIdleMode must return the error code and exit the idle mode
+ *        when arming a wake-up interrupt fails.
+*/
+ZTEST(buttonMngr_suite, test_enterIdleMode_ArmFail)
+{
+  int failRet = -EBUSY;
+
+  initWakeupSources();
+  zephyrGpioEnableIrq_fake.return_val = failRet;
+
+  zassert_equal(failRet, enterIdleMode());
+  zassert_equal(1, zephyrGpioEnableIrq_fake.call_count);
+  zassert_equal(0, zephyrGpioRead_fake.call_count);
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT,
+    gpioPortDisablePinIrq_fake.call_count);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+}
+
+/**
+ * @test  exitIdleMode must disarm all the wake-up interrupts and clear all
+ *        the columns even if one of the operations fails.
+*/
+ZTEST(buttonMngr_suite, test_exitIdleMode_DisarmAll)
+{
+  int successRet = 0;
+  int failRet = -EIO;
+
+  initWakeupSources();
+
+  zassert_equal(successRet, exitIdleMode());
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT,
+    gpioPortDisablePinIrq_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_MNGR_WAKEUP_SRC_CNT; ++i)
+    zassert_equal(&wakeupSources[i]->dev,
+      gpioPortDisablePinIrq_fake.arg0_history[i]);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
+    zassert_equal(columns + i, zephyrGpioClear_fake.arg0_history[i]);
+
+  RESET_FAKE(gpioPortDisablePinIrq);
+  RESET_FAKE(zephyrGpioClear);
+  gpioPortDisablePinIrq_fake.return_val = failRet;
+
+  zassert_equal(failRet, exitIdleMode());
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT,
+    gpioPortDisablePinIrq_fake.call_count);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+}
+
+/**
+ * @test  waitForWakeup must disable the idle mode and return the error code
+ *        when arming a wake-up interrupt fails.
+*/
+ZTEST(buttonMngr_suite, test_waitForWakeup_EnterFail)
+{
+  int failRet = -EBUSY;
+
+  pollTestEncoders();
+  initWakeupSources();
+  zephyrGpioEnableIrq_fake.return_val = failRet;
+
+  zassert_equal(failRet, waitForWakeup());
+  zassert_false(wakeupIrqAvailable);
+  zassert_equal(0, atomic_get(&idleFlag));
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+}
+
+/**
+ * @test  An encoder step landing while the button thread is idle must wake
+ *        the thread up, whose next scan posts the step to the subscribers.
+*/
+ZTEST(buttonMngr_suite, test_encoderIrq_WakeUpIdle)
+{
+  int incStates[BUTTON_MNGR_ENC_SIG_CNT] = {GPIO_CLR, GPIO_CLR};
+  ButtonMngrEvent event;
+
+  zassert_equal(0, buttonMngrSubscribe(&testEventQueue));
+  atomic_set(&inputBits, 0);
+  atomic_set(&encoderBits, 0);
+  matrixRaw = 0;
+  testPortValue = 0;
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+
+  /* not idle, no wake-up */
+  SET_RETURN_SEQ(zephyrGpioRead, incStates, BUTTON_MNGR_ENC_SIG_CNT);
+  encoders[TC_ENC_IDX].state = 1;
+  encoderIrq(NULL, TEST_ENC_CB(TC_ENC_IDX, 0), 0);
+  zassert_equal(0, k_sem_count_get(&wakeupSem));
+  zassert_true(scanButtons(TEST_SCAN_CYCLE));
+  zassert_equal(0, k_msgq_get(&testEventQueue, &event, K_NO_WAIT));
+
+  /* idle, the step wakes the thread up */
+  RESET_FAKE(zephyrGpioRead);
+  SET_RETURN_SEQ(zephyrGpioRead, incStates, BUTTON_MNGR_ENC_SIG_CNT);
+  atomic_set(&idleFlag, 1);
+  encoders[TC_ENC_IDX].state = 1;
+  encoderIrq(NULL, TEST_ENC_CB(TC_ENC_IDX, 0), 0);
+  zassert_equal(1, k_sem_count_get(&wakeupSem));
+
+  atomic_clear(&idleFlag);
+  RESET_FAKE(zephyrGpioRead);
+  zassert_true(scanButtons(TEST_SCAN_CYCLE));
+  zassert_equal(0, k_msgq_get(&testEventQueue, &event, K_NO_WAIT));
+  zassert_equal(BIT64(TC_INC_IDX), event.changed);
+  zassert_equal(BIT64(TC_INC_IDX), event.states);
+  zassert_equal(TEST_SCAN_CYCLE, event.cycle);
+  zassert_equal(1, event.edgeCount);
+  zassert_equal(TC_INC_IDX, event.edges[0].idx);
+  zassert_equal(edgeCycles[TC_INC_IDX], event.edges[0].cycle);
+}
+
+/**
+ * @test  waitForWakeup must exit the idle mode once woken up.
+*/
+ZTEST(buttonMngr_suite, test_waitForWakeup_WokenUp)
+{
+  int successRet = 0;
+
+  pollTestEncoders();
+  initWakeupSources();
+  zephyrGpioRead_fake.return_val = GPIO_SET;
+
+  zassert_equal(successRet, waitForWakeup());
+  zassert_true(wakeupIrqAvailable);
+  zassert_equal(0, atomic_get(&idleFlag));
+  zassert_equal(BUTTON_MNGR_WAKEUP_SRC_CNT,
+    gpioPortDisablePinIrq_fake.call_count);
+  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
+}
+#endif
+
+#define SCAN_STATS_TEST_CNT       3
+/**
+ * @test  updateScanStats must only record the scan cycle count after a
+ *        restart and then measure the scan periods and jitter.
+*/
+ZTEST(buttonMngr_suite, test_updateScanStats_MeasurePeriods)
+{
+  uint32_t now = UINT32_MAX - 10;
+  uint32_t periodsUs[SCAN_STATS_TEST_CNT] = {BUTTON_MNGR_SCAN_PERIOD_US,
+                                             BUTTON_MNGR_SCAN_PERIOD_US - 100,
+                                             BUTTON_MNGR_SCAN_PERIOD_US + 250};
+  ButtonMngrScanStats stats;
+
+  updateScanStats(now);
+  buttonMngrGetScanStats(&stats);
+  zassert_equal(0, stats.scanCount);
+  zassert_equal(now, lastScanCycle);
+
+  for(uint8_t i = 0; i < SCAN_STATS_TEST_CNT; ++i)
+  {
+    now += k_us_to_cyc_near32(periodsUs[i]);
+    updateScanStats(now);
   }
+
+  buttonMngrGetScanStats(&stats);
+  zassert_equal(SCAN_STATS_TEST_CNT, stats.scanCount);
+  zassert_equal(BUTTON_MNGR_SCAN_PERIOD_US, stats.periodUs);
+  zassert_equal(BUTTON_MNGR_SCAN_PERIOD_US - 100, stats.minPeriodUs);
+  zassert_equal(BUTTON_MNGR_SCAN_PERIOD_US + 250, stats.maxPeriodUs);
+  zassert_equal(250, stats.maxJitterUs);
 }
 
 /**
- * @test  readButtonMatrix must return the error code if any of the set column
- *        operation fails.
+ * @test  buttonMngrResetScanStats must clear the statistics and restart the
+ *        measurement.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonMatrix_SetColumnFail)
+ZTEST(buttonMngr_suite, test_buttonMngrResetScanStats_Reset)
 {
-  int failRet = -EIO;
-  int successRet = 0;
+  ButtonMngrScanStats stats;
 
-  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
-  {
-    if(i > 0)
-      fixture->colSetRetVals[i - 1] = successRet;
-    fixture->colSetRetVals[i] = failRet;
-    SET_RETURN_SEQ(zephyrGpioSet, fixture->colSetRetVals, i + 1);
+  updateScanStats(0);
+  updateScanStats(k_us_to_cyc_near32(BUTTON_MNGR_SCAN_PERIOD_US + 10));
 
-    zassert_equal(failRet, readButtonMatrix());
-    zassert_equal(i + 1, zephyrGpioSet_fake.call_count);
-    for(uint8_t j = 0; j > i; ++j)
-      zassert_equal(columns + j, zephyrGpioSet_fake.arg0_history[j]);
-    RESET_FAKE(zephyrGpioSet);
-  }
+  buttonMngrResetScanStats();
+
+  buttonMngrGetScanStats(&stats);
+  zassert_true(scanStatsRestart);
+  zassert_equal(0, stats.scanCount);
+  zassert_equal(UINT32_MAX, stats.minPeriodUs);
+  zassert_equal(0, stats.maxPeriodUs);
+  zassert_equal(0, stats.maxJitterUs);
 }
 
 /**
- * @test  readButtonMatrix must return the error code if any of the clear column
- *        operation fails.
+ * @test  scanTimerExpiry must give the scan semaphore.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonMatrix_ClearColumnFail)
+ZTEST(buttonMngr_suite, test_scanTimerExpiry_GiveSemaphore)
 {
-  int failRet = -EIO;
-  int successRet = 0;
+  k_sem_reset(&scanSem);
 
-  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
-  {
-    SET_RETURN_SEQ(zephyrGpioSet, fixture->colSetRetVals, i + 1);
-
-    if(i > 0)
-      fixture->colClearRetVals[i - 1] = successRet;
-    fixture->colClearRetVals[i] = failRet;
-    SET_RETURN_SEQ(zephyrGpioClear, fixture->colClearRetVals, i + 1);
+  scanTimerExpiry(&scanTimer);
 
-    zassert_equal(failRet, readButtonMatrix());
-    zassert_equal(i + 1, zephyrGpioClear_fake.call_count);
-    for(uint8_t j = 0; j > i; ++j)
-      zassert_equal(columns + j, zephyrGpioClear_fake.arg0_history[j]);
-    RESET_FAKE(zephyrGpioClear);
-  }
+  zassert_equal(1, k_sem_count_get(&scanSem));
 }
 
+#define ENC_GPIO_INIT_OP_CNT            3
 /**
- * @test  readButtonMatrix must return the error code and clear the column
- *        if any of the read row operation fails.
+ * @test  isEncoderLineShared must detect the signals sharing an EXTI line
+ *        with each other or with an earlier encoder using its IRQs.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonMatrix_ReadRowFail)
+ZTEST(buttonMngr_suite, test_isEncoderLineShared_DetectConflicts)
 {
-  int failRet = -EIO;
-  int successRet = 0;
+  zassert_false(isEncoderLineShared(encoders + TC_ENC_IDX));
 
-  for(uint8_t i = 0; i < BUTTON_ROW_COUNT; ++i)
-  {
-    zephyrGpioSet_fake.return_val = successRet;
+  encoders[TC_ENC_IDX].signals[1].dev.pin = encoders[TC_ENC_IDX].signals[0].dev.pin;
+  zassert_true(isEncoderLineShared(encoders + TC_ENC_IDX));
 
-    if(i > 0)
-      fixture->readRetVals[i - 1] = successRet;
-    fixture->readRetVals[i] = failRet;
-    SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, i + 1);
+  encoders[TC_ENC_IDX].signals[1].dev.pin = encoders[RIGHT_ENC_IDX].signals[0].dev.pin;
+  zassert_true(isEncoderLineShared(encoders + TC_ENC_IDX));
+  zassert_false(isEncoderLineShared(encoders + RIGHT_ENC_IDX));
 
-    zephyrGpioClear_fake.return_val = successRet;
+  encoders[RIGHT_ENC_IDX].polled = true;
+  zassert_false(isEncoderLineShared(encoders + TC_ENC_IDX));
 
-    zassert_equal(failRet, readButtonMatrix());
-    zassert_equal(i + 1, zephyrGpioRead_fake.call_count);
-    zassert_equal(1, zephyrGpioClear_fake.call_count);
-    zassert_equal(columns, zephyrGpioClear_fake.arg0_val);
-    for(uint8_t j = 0; j > i; ++j)
-      zassert_equal(rows + j, zephyrGpioRead_fake.arg0_history[j]);
-    RESET_FAKE(zephyrGpioRead);
-    RESET_FAKE(zephyrGpioClear);
-  }
+  encoders[RIGHT_ENC_IDX].polled = false;
+  encoders[RIGHT_ENC_IDX].disabled = true;
+  zassert_false(isEncoderLineShared(encoders + TC_ENC_IDX));
 }
 
 /**
- * @test  readButtonMatrix must return the success code and update the button
- *        states when all operations succeeds.
+ * @test  initEncoder must poll an encoder whose signals share an EXTI line
+ *        from different ports, without arming its IRQs.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonMatrix_Success)
+ZTEST(buttonMngr_suite, test_initEncoder_SharedLinePolled)
 {
-  int successRet = 0;
-
-  SET_RETURN_SEQ(zephyrGpioSet, fixture->colSetRetVals, BUTTON_COL_COUNT);
-  SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals,
-    BUTTON_ROW_COUNT * BUTTON_COL_COUNT);
-  SET_RETURN_SEQ(zephyrGpioClear, fixture->colClearRetVals, BUTTON_COL_COUNT);
+  EncoderDesc *enc = encoders + MAP_ENC_IDX;
 
-  zassert_equal(successRet, readButtonMatrix());
-  zassert_equal(BUTTON_COL_COUNT, zephyrGpioSet_fake.call_count);
-  zassert_equal(BUTTON_ROW_COUNT * BUTTON_COL_COUNT,
-    zephyrGpioRead_fake.call_count);
-  zassert_equal(BUTTON_COL_COUNT, zephyrGpioClear_fake.call_count);
-  for(uint8_t i = 0; i < BUTTON_COL_COUNT; ++i)
-  {
-    zassert_equal(columns + i, zephyrGpioSet_fake.arg0_history[i]);
-    zassert_equal(columns + i, zephyrGpioClear_fake.arg0_history[i]);
-  }
+  enc->signals[1].dev.pin = enc->signals[0].dev.pin;
 
-  for(uint8_t i = 0; i < BUTTON_ROW_COUNT * BUTTON_COL_COUNT; ++i)
-  {
-    zassert_equal(rows + (i % 8), zephyrGpioRead_fake.arg0_history[i]);
-    zassert_equal(fixture->readRetVals[i], buttonStates[i]);
-  }
+  zassert_equal(0, initEncoder(enc));
+  zassert_true(enc->polled);
+  zassert_equal(BUTTON_MNGR_ENC_SIG_CNT, zephyrGpioInit_fake.call_count);
+  zassert_equal(0, zephyrGpioAddIrqCallback_fake.call_count);
+  zassert_equal(0, zephyrGpioEnableIrq_fake.call_count);
 }
 
 /**
- * @test  readButtonShifters must return the error code if any of the read
- *        operation fails.
+ * @test  initEncoder must leave an encoder with both signals on the same pin
+ *        disabled, neither polled nor using its IRQs.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonShifters_ReadFail)
+ZTEST(buttonMngr_suite, test_initEncoder_SamePinDisabled)
 {
-  int failRet = -EIO;
-  int successRet = 0;
+  EncoderDesc *enc = encoders + MAP_ENC_IDX;
 
-  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT; ++i)
-  {
-    if(i > 0)
-      fixture->readRetVals[i - 1] = successRet;
-    fixture->readRetVals[i] = failRet;
-    SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, i + 1);
+  enc->signals[1].dev.port = enc->signals[0].dev.port;
+  enc->signals[1].dev.pin = enc->signals[0].dev.pin;
 
-    zassert_equal(failRet, readButtonShifters());
-    zassert_equal(i + 1, zephyrGpioRead_fake.call_count);
-    for(uint8_t j = 0; j > i; ++j)
-      zassert_equal(shifters + j, zephyrGpioRead_fake.arg0_history[j]);
-    RESET_FAKE(zephyrGpioRead);
-  }
+  zassert_equal(0, initEncoder(enc));
+  zassert_true(enc->disabled);
+  zassert_false(enc->polled);
+  zassert_false(isEncoderIrqDriven(enc));
+  zassert_equal(0, zephyrGpioInit_fake.call_count);
+  zassert_equal(0, zephyrGpioAddIrqCallback_fake.call_count);
+  zassert_equal(0, zephyrGpioEnableIrq_fake.call_count);
+
+  initEncoderPollPorts();
+  zassert_equal(0, encPollPortCount);
 }
 
 /**
- * @test  readButtonShifters must return the success code and update the
- *        shifters button states when all operations succeed.
+ * @test  initEncoder must fall back to polling when an EXTI line is already
+ *        taken and disarm the encoder IRQs.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonShifters_Success)
+ZTEST(buttonMngr_suite, test_initEncoder_BusyLineFallback)
 {
-  int successRet = 0;
+  EncoderDesc *enc = encoders + TC1_ENC_IDX;
+  int enableRetVals[BUTTON_MNGR_ENC_SIG_CNT] = {0, -EBUSY};
 
-  SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, BUTTON_SHIFTER_COUNT);
+  SET_RETURN_SEQ(zephyrGpioEnableIrq, enableRetVals, BUTTON_MNGR_ENC_SIG_CNT);
 
-  zassert_equal(successRet, readButtonShifters());
-  zassert_equal(BUTTON_SHIFTER_COUNT, zephyrGpioRead_fake.call_count);
-  for(uint8_t i = 0; i < BUTTON_SHIFTER_COUNT; ++i)
-  {
-    zassert_equal(shifters + i, zephyrGpioRead_fake.arg0_history[i]);
-    zassert_equal(fixture->readRetVals[i],
-      buttonStates[LEFT_SHIFTER_IDX + i]);
-  }
+  zassert_equal(0, initEncoder(enc));
+  zassert_true(enc->polled);
+  zassert_equal(BUTTON_MNGR_ENC_SIG_CNT, gpioPortDisablePinIrq_fake.call_count);
+  zassert_equal(&enc->signals[0].dev, gpioPortDisablePinIrq_fake.arg0_history[0]);
+  zassert_equal(&enc->signals[1].dev, gpioPortDisablePinIrq_fake.arg0_history[1]);
+  zassert_equal(2 * BUTTON_MNGR_ENC_SIG_CNT, zephyrGpioInit_fake.call_count);
 }
 
 /**
- * @test  readButtonRockers must return the error code if any of the read
- *        operation fails.
+ * @test  initEncoderPollPorts must list each port of the polled encoders once
+ *        and store the port index of their signals.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonRockers_ReadFail)
+ZTEST(buttonMngr_suite, test_initEncoderPollPorts_ListPorts)
 {
-  int failRet = -EIO;
-  int successRet = 0;
-
-  for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT; ++i)
-  {
-    if(i > 0)
-      fixture->readRetVals[i - 1] = successRet;
-    fixture->readRetVals[i] = failRet;
-    SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, i + 1);
+  encoders[ABS_ENC_IDX].polled = true;
+  encoders[MAP_ENC_IDX].polled = true;
+  encoders[MAP_ENC_IDX].signals[1].dev.port = testEncPorts;
+
+  initEncoderPollPorts();
+
+  zassert_equal(BUTTON_MNGR_ENC_SIG_CNT, encPollPortCount);
+  zassert_equal(testEncPorts, encPollPorts[0]);
+  zassert_equal(testEncPorts + 1, encPollPorts[1]);
+  zassert_equal(0, encoders[ABS_ENC_IDX].pollPorts[0]);
+  zassert_equal(1, encoders[ABS_ENC_IDX].pollPorts[1]);
+  zassert_equal(0, encoders[MAP_ENC_IDX].pollPorts[0]);
+  zassert_equal(0, encoders[MAP_ENC_IDX].pollPorts[1]);
+}
 
-    zassert_equal(failRet, readButtonRockers());
-    zassert_equal(i + 1, zephyrGpioRead_fake.call_count);
-    for(uint8_t j = 0; j > i; ++j)
-      zassert_equal(rockers + j, zephyrGpioRead_fake.arg0_history[j]);
-    RESET_FAKE(zephyrGpioRead);
-  }
+/**
+ * @test  The encoder poll timer must read each polled port once and decode
+ *        the polled encoders only.
+*/
+ZTEST(buttonMngr_suite, test_encoderPollExpiry_DecodePolled)
+{
+  encoders[ABS_ENC_IDX].polled = true;
+  encoders[ABS_ENC_IDX].state = 1;
+  encoders[MAP_ENC_IDX].polled = true;
+  initEncoderPollPorts();
+
+  /* ABS signals cleared, MAP signal A set */
+  testPortValue = BIT(encoders[MAP_ENC_IDX].signals[0].dev.pin);
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+
+  encoderPollExpiry(NULL);
+
+  zassert_equal(BUTTON_MNGR_ENC_SIG_CNT, gpioPortRead_fake.call_count);
+  zassert_equal(0, zephyrGpioRead_fake.call_count);
+  zassert_equal(1, atomic_get(encSteps + ABS_ENC_IDX));
+  zassert_equal(1, atomic_get(encSteps + MAP_ENC_IDX));
+  zassert_equal(0, atomic_get(encSteps + TC_ENC_IDX));
 }
 
 /**
- * @test  readButtonRockers must return the success code and update the
- *        rockers button states when all operations succeed.
+ * @test  The encoder poll timer must skip the encoders on a port that cannot
+ *        be read.
 */
-ZTEST_F(buttonMngr_suite, test_readButtonRockers_Success)
+ZTEST(buttonMngr_suite, test_encoderPollExpiry_ReadFail)
 {
-  int successRet = 0;
+  encoders[ABS_ENC_IDX].polled = true;
+  encoders[ABS_ENC_IDX].state = 1;
+  initEncoderPollPorts();
+  gpioPortRead_fake.return_val = -EIO;
 
-  SET_RETURN_SEQ(zephyrGpioRead, fixture->readRetVals, BUTTON_ROCKER_COUNT);
+  encoderPollExpiry(NULL);
 
-  zassert_equal(successRet, readButtonRockers());
-  zassert_equal(BUTTON_ROCKER_COUNT, zephyrGpioRead_fake.call_count);
-  for(uint8_t i = 0; i < BUTTON_ROCKER_COUNT; ++i)
-  {
-    zassert_equal(rockers + i, zephyrGpioRead_fake.arg0_history[i]);
-    zassert_equal(fixture->readRetVals[i],
-      buttonStates[LEFT_ROCKER_IDX + i]);
-  }
+  zassert_equal(1, encoders[ABS_ENC_IDX].state);
+  zassert_equal(0, atomic_get(encSteps + ABS_ENC_IDX));
 }
 
-#define ENC_GPIO_INIT_OP_CNT            3
 /**
  * @test  initEncoderGpio must return the error code as soon as initializing
  *        the encoder GPIO fails.
@@ -713,9 +2112,9 @@ ZTEST(buttonMngr_suite, test_initEncoderGpio_GpioInitFail)
     zephyrGpioAddIrqCallback_fake.return_val = gpioAddIrqRetVals[i];
     zephyrGpioEnableIrq_fake.return_val = gpioEnIrqRetVals[i];
 
-    zassert_equal(failRet, initEncoderGpio(leftEncoder, leftEncoderIrq));
+    zassert_equal(failRet, initEncoderGpio(encoders[LEFT_ENC_IDX].signals, encoderIrq));
     zassert_equal(1, zephyrGpioInit_fake.call_count);
-    zassert_equal(leftEncoder, zephyrGpioInit_fake.arg0_val);
+    zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioInit_fake.arg0_val);
     zassert_equal(GPIO_IN, zephyrGpioInit_fake.arg1_val);
 
     if(i == 0)
@@ -726,17 +2125,17 @@ ZTEST(buttonMngr_suite, test_initEncoderGpio_GpioInitFail)
     else if(i == 1)
     {
       zassert_equal(1, zephyrGpioAddIrqCallback_fake.call_count);
-      zassert_equal(leftEncoder, zephyrGpioAddIrqCallback_fake.arg0_val);
-      zassert_equal(leftEncoderIrq, zephyrGpioAddIrqCallback_fake.arg1_val);
+      zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioAddIrqCallback_fake.arg0_val);
+      zassert_equal(encoderIrq, zephyrGpioAddIrqCallback_fake.arg1_val);
       zassert_equal(0, zephyrGpioEnableIrq_fake.call_count);
     }
     else
     {
       zassert_equal(1, zephyrGpioAddIrqCallback_fake.call_count);
-      zassert_equal(leftEncoder, zephyrGpioAddIrqCallback_fake.arg0_val);
-      zassert_equal(leftEncoderIrq, zephyrGpioAddIrqCallback_fake.arg1_val);
+      zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioAddIrqCallback_fake.arg0_val);
+      zassert_equal(encoderIrq, zephyrGpioAddIrqCallback_fake.arg1_val);
       zassert_equal(1, zephyrGpioEnableIrq_fake.call_count);
-      zassert_equal(leftEncoder, zephyrGpioEnableIrq_fake.arg0_val);
+      zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioEnableIrq_fake.arg0_val);
       zassert_equal(GPIO_IRQ_EDGE_BOTH, zephyrGpioEnableIrq_fake.arg1_val);
     }
 
@@ -758,15 +2157,15 @@ ZTEST(buttonMngr_suite, test_initEncoderGpio_GpioInitSuccess)
   zephyrGpioAddIrqCallback_fake.return_val = successRet;
   zephyrGpioEnableIrq_fake.return_val = successRet;
 
-  zassert_equal(successRet, initEncoderGpio(leftEncoder, leftEncoderIrq));
+  zassert_equal(successRet, initEncoderGpio(encoders[LEFT_ENC_IDX].signals, encoderIrq));
   zassert_equal(1, zephyrGpioInit_fake.call_count);
-  zassert_equal(leftEncoder, zephyrGpioInit_fake.arg0_val);
+  zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioInit_fake.arg0_val);
   zassert_equal(GPIO_IN, zephyrGpioInit_fake.arg1_val);
   zassert_equal(1, zephyrGpioAddIrqCallback_fake.call_count);
-  zassert_equal(leftEncoder, zephyrGpioAddIrqCallback_fake.arg0_val);
-  zassert_equal(leftEncoderIrq, zephyrGpioAddIrqCallback_fake.arg1_val);
+  zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioAddIrqCallback_fake.arg0_val);
+  zassert_equal(encoderIrq, zephyrGpioAddIrqCallback_fake.arg1_val);
   zassert_equal(1, zephyrGpioEnableIrq_fake.call_count);
-  zassert_equal(leftEncoder, zephyrGpioEnableIrq_fake.arg0_val);
+  zassert_equal(encoders[LEFT_ENC_IDX].signals, zephyrGpioEnableIrq_fake.arg0_val);
   zassert_equal(GPIO_IRQ_EDGE_BOTH, zephyrGpioEnableIrq_fake.arg1_val);
 }
 
@@ -920,7 +2319,7 @@ ZTEST_F(buttonMngr_suite, test_ButtonMngrInit_LeftEncoderFail)
     zassert_equal(leftEncOffset + i + 1, zephyrGpioInit_fake.call_count);
     for(uint8_t j = 0; j < i; ++j)
     {
-      zassert_equal(leftEncoder + j,
+      zassert_equal(encoders[LEFT_ENC_IDX].signals + j,
         zephyrGpioInit_fake.arg0_history[leftEncOffset + j]);
       zassert_equal(GPIO_IN,
         zephyrGpioInit_fake.arg1_history[leftEncOffset + j]);
@@ -954,7 +2353,7 @@ ZTEST_F(buttonMngr_suite, test_ButtonMngrInit_RightEncoderFail)
     zassert_equal(rightEncOffset + i + 1, zephyrGpioInit_fake.call_count);
     for(uint8_t j = 0; j < i; ++j)
     {
-      zassert_equal(rightEncoder + j,
+      zassert_equal(encoders[RIGHT_ENC_IDX].signals + j,
         zephyrGpioInit_fake.arg0_history[rightEncOffset + j]);
       zassert_equal(GPIO_IN,
         zephyrGpioInit_fake.arg1_history[rightEncOffset + j]);
@@ -988,7 +2387,7 @@ ZTEST_F(buttonMngr_suite, test_ButtonMngrInit_TcEncoderFail)
     zassert_equal(tcEncOffset + i + 1, zephyrGpioInit_fake.call_count);
     for(uint8_t j = 0; j < i; ++j)
     {
-      zassert_equal(tcEncoder + j,
+      zassert_equal(encoders[TC_ENC_IDX].signals + j,
         zephyrGpioInit_fake.arg0_history[tcEncOffset + j]);
       zassert_equal(GPIO_IN,
         zephyrGpioInit_fake.arg1_history[tcEncOffset + j]);
@@ -1022,7 +2421,7 @@ ZTEST_F(buttonMngr_suite, test_ButtonMngrInit_Tc1EncoderFail)
     zassert_equal(tc1EncOffset + i + 1, zephyrGpioInit_fake.call_count);
     for(uint8_t j = 0; j < i; ++j)
     {
-      zassert_equal(tc1Encoder + j,
+      zassert_equal(encoders[TC1_ENC_IDX].signals + j,
         zephyrGpioInit_fake.arg0_history[tc1EncOffset + j]);
       zassert_equal(GPIO_IN,
         zephyrGpioInit_fake.arg1_history[tc1EncOffset + j]);
@@ -1056,7 +2455,7 @@ ZTEST_F(buttonMngr_suite, test_ButtonMngrInit_AbsEncoderFail)
     zassert_equal(absEncOffset + i + 1, zephyrGpioInit_fake.call_count);
     for(uint8_t j = 0; j < i; ++j)
     {
-      zassert_equal(absEncoder + j,
+      zassert_equal(encoders[ABS_ENC_IDX].signals + j,
         zephyrGpioInit_fake.arg0_history[absEncOffset + j]);
       zassert_equal(GPIO_IN,
         zephyrGpioInit_fake.arg1_history[absEncOffset + j]);
@@ -1090,7 +2489,7 @@ ZTEST_F(buttonMngr_suite, test_ButtonMngrInit_MapEncoderFail)
     zassert_equal(mapEncOffset + i + 1, zephyrGpioInit_fake.call_count);
     for(uint8_t j = 0; j < i; ++j)
     {
-      zassert_equal(mapEncoder + j,
+      zassert_equal(encoders[MAP_ENC_IDX].signals + j,
         zephyrGpioInit_fake.arg0_history[mapEncOffset + j]);
       zassert_equal(GPIO_IN,
         zephyrGpioInit_fake.arg1_history[mapEncOffset + j]);
@@ -1100,6 +2499,21 @@ ZTEST_F(buttonMngr_suite, test_ButtonMngrInit_MapEncoderFail)
   }
 }
 
+/**
+ * @test  buttonMngrInit must return the error code when the initialization
+ *        of a debouncer fails.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrInit_DebouncerFail)
+{
+  int failRet = -EINVAL;
+
+  debounceInit_fake.return_val = failRet;
+
+  zassert_equal(failRet, buttonMngrInit());
+  zassert_equal(1, debounceInit_fake.call_count);
+  zassert_equal(0, zephyrThreadCreate_fake.call_count);
+}
+
 /**
  * @test  buttonMngrInit must return the success code when the initialization
  *        succeeds and create the thread.
@@ -1138,43 +2552,46 @@ ZTEST_F(buttonMngr_suite, test_buttonMngrInit_Success)
     }
     else if(i < TOTAL_GPIO_COUNT - 5 * BUTTON_MNGR_ENC_SIG_CNT)
     {
-      expectedGpio = leftEncoder +
+      expectedGpio = encoders[LEFT_ENC_IDX].signals +
         (i - TOTAL_GPIO_COUNT + 6 * BUTTON_MNGR_ENC_SIG_CNT);
       expectedDir = GPIO_IN;
     }
     else if(i < TOTAL_GPIO_COUNT - 4 * BUTTON_MNGR_ENC_SIG_CNT)
     {
-      expectedGpio = rightEncoder +
+      expectedGpio = encoders[RIGHT_ENC_IDX].signals +
         (i - TOTAL_GPIO_COUNT + 5 * BUTTON_MNGR_ENC_SIG_CNT);
       expectedDir = GPIO_IN;
     }
     else if(i < TOTAL_GPIO_COUNT - 3 * BUTTON_MNGR_ENC_SIG_CNT)
     {
-      expectedGpio = tcEncoder +
+      expectedGpio = encoders[TC_ENC_IDX].signals +
         (i - TOTAL_GPIO_COUNT + 4 * BUTTON_MNGR_ENC_SIG_CNT);
       expectedDir = GPIO_IN;
     }
     else if(i < TOTAL_GPIO_COUNT - 2 * BUTTON_MNGR_ENC_SIG_CNT)
     {
-      expectedGpio = tc1Encoder +
+      expectedGpio = encoders[TC1_ENC_IDX].signals +
         (i - TOTAL_GPIO_COUNT + 3 * BUTTON_MNGR_ENC_SIG_CNT);
       expectedDir = GPIO_IN;
     }
     else if(i < TOTAL_GPIO_COUNT - BUTTON_MNGR_ENC_SIG_CNT)
     {
-      expectedGpio = absEncoder +
+      expectedGpio = encoders[ABS_ENC_IDX].signals +
         (i - TOTAL_GPIO_COUNT + 2 * BUTTON_MNGR_ENC_SIG_CNT);
       expectedDir = GPIO_IN;
     }
     else
     {
-      expectedGpio = mapEncoder +
+      expectedGpio = encoders[MAP_ENC_IDX].signals +
         (i - TOTAL_GPIO_COUNT + BUTTON_MNGR_ENC_SIG_CNT);
       expectedDir = GPIO_IN;
     }
     zassert_equal(expectedGpio, zephyrGpioInit_fake.arg0_history[i]);
     zassert_equal(expectedDir, zephyrGpioInit_fake.arg1_history[i]);
   }
+  zassert_equal(DEBOUNCER_COUNT, debounceInit_fake.call_count);
+  zassert_equal(BUTTON_MNGR_SETTLE_MAX_CYCLES, settleCycles);
+  zassert_equal(0, zephyrGpioSet_fake.call_count);
   zassert_equal(1, zephyrThreadCreate_fake.call_count);
   zassert_equal(&thread, zephyrThreadCreate_fake.arg0_val);
   zassert_equal(BUTTON_MNGR_THREAD_NAME, zephyrThreadCreate_fake.arg1_val);
@@ -1206,18 +2623,321 @@ ZTEST_F(buttonMngr_suite, test_buttonMngrGetAllStates_BadCount)
 ZTEST_F(buttonMngr_suite, test_buttonMngrGetAllStates_Success)
 {
   int successRet = 0;
-  WheelButtonState expectedStates[BUTTON_COUNT];
-
-  bytecpy(expectedStates, buttonStates, BUTTON_COUNT);
 
   zassert_equal(successRet, buttonMngrGetAllStates(fixture->buttonStates,
     BUTTON_COUNT));
 
   for(uint8_t i = 0; i < BUTTON_COUNT; ++i)
-    zassert_equal(expectedStates[i], fixture->buttonStates[i]);
+    zassert_equal(i % 2 ? BUTTON_PRESSED : BUTTON_DEPRESSED,
+      fixture->buttonStates[i]);
+
+  zassert_equal(TEST_INPUT_BITS, (uint32_t)atomic_get(&inputBits));
+  zassert_equal(0, atomic_get(&encoderBits));
+}
+
+/**
+ * @test  buttonMngrGetSnapshot must return the input and encoder button
+ *        states packed in a single word and reset the encoder states.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrGetSnapshot_PackedStates)
+{
+  WheelButtonBits expected = (WheelButtonBits)TEST_ENCODER_BITS << TC_INC_IDX |
+    TEST_INPUT_BITS;
+
+  zassert_equal(expected, buttonMngrGetSnapshot());
+  zassert_equal(TEST_INPUT_BITS, (uint32_t)atomic_get(&inputBits));
+  zassert_equal(0, atomic_get(&encoderBits));
+
+  zassert_equal(TEST_INPUT_BITS, buttonMngrGetSnapshot());
+}
+
+/**
+ * @test  buttonMngrGetSnapshot must keep an encoder press set after a read
+ *        for the next read only.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrGetSnapshot_PressAfterRead)
+{
+  atomic_clear(&encoderBits);
+  zassert_equal(TEST_INPUT_BITS, buttonMngrGetSnapshot());
+
+  pressEncoderButton(ABS_DEC_IDX);
+  zassert_equal(BIT64(ABS_DEC_IDX) | TEST_INPUT_BITS, buttonMngrGetSnapshot());
+  zassert_equal(TEST_INPUT_BITS, buttonMngrGetSnapshot());
+}
+
+/**
+ * @test  buttonMngrSubscribe must return the error code when the queue is
+ *        missing or its message size is not the event size.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrSubscribe_BadQueue)
+{
+  int failRet = -EINVAL;
+
+  zassert_equal(failRet, buttonMngrSubscribe(NULL));
+  zassert_equal(failRet, buttonMngrSubscribe(&testBadQueue));
+  zassert_equal(0, atomic_get(&subscriberCount));
+}
+
+/**
+ * @test  buttonMngrSubscribe must return the error code once all the
+ *        subscriber slots are taken.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrSubscribe_Full)
+{
+  int failRet = -ENOMEM;
+
+  for(uint8_t i = 0; i < CONFIG_BUTTON_MNGR_SUBSCRIBER_COUNT; ++i)
+  {
+    zassert_equal(0, buttonMngrSubscribe(&testEventQueue));
+    zassert_equal(&testEventQueue, subscribers[i]);
+  }
+
+  zassert_equal(failRet, buttonMngrSubscribe(&testEventQueue));
+  zassert_equal(CONFIG_BUTTON_MNGR_SUBSCRIBER_COUNT,
+    atomic_get(&subscriberCount));
+}
+
+/**
+ * @test  notifySubscribers must post the changed buttons, their new states
+ *        and their edges, only when a button changed.
+*/
+ZTEST(buttonMngr_suite, test_notifySubscribers_PostChanges)
+{
+  uint32_t inputs = TEST_INPUT_BITS ^ BIT(RIGHT_SIDE_SEL_IDX);
+  ButtonMngrEvent event;
+
+  zassert_equal(0, buttonMngrSubscribe(&testEventQueue));
+
+  notifySubscribers(TEST_SCAN_CYCLE);
+  zassert_equal(0, k_msgq_get(&testEventQueue, &event, K_NO_WAIT));
+  zassert_equal(TEST_INPUT_BITS, event.changed);
+  zassert_equal(TEST_INPUT_BITS, event.states);
+  zassert_equal(TEST_SCAN_CYCLE, event.cycle);
+  zassert_equal(BUTTON_MNGR_EVENT_EDGE_MAX, event.edgeCount);
+  zassert_equal(u32_count_trailing_zeros(TEST_INPUT_BITS), event.edges[0].idx);
+
+  notifySubscribers(TEST_SCAN_CYCLE);
+  zassert_equal(0, k_msgq_num_used_get(&testEventQueue));
+
+  atomic_set(&inputBits, inputs);
+  edgeCycles[RIGHT_SIDE_SEL_IDX] = TEST_SCAN_CYCLE;
+  pressEncoderButton(MAP_INC_IDX);
+  notifySubscribers(TEST_SCAN_CYCLE + 1);
+  zassert_equal(0, k_msgq_get(&testEventQueue, &event, K_NO_WAIT));
+  zassert_equal(BIT64(RIGHT_SIDE_SEL_IDX) | BIT64(MAP_INC_IDX), event.changed);
+  zassert_equal((WheelButtonBits)inputs | BIT64(MAP_INC_IDX), event.states);
+  zassert_equal(2, event.edgeCount);
+  zassert_equal(RIGHT_SIDE_SEL_IDX, event.edges[0].idx);
+  zassert_equal(TEST_SCAN_CYCLE, event.edges[0].cycle);
+  zassert_equal(MAP_INC_IDX, event.edges[1].idx);
+  zassert_equal(edgeCycles[MAP_INC_IDX], event.edges[1].cycle);
+
+  notifySubscribers(TEST_SCAN_CYCLE);
+  zassert_equal(0, k_msgq_num_used_get(&testEventQueue));
+}
+
+/**
+ * @test  scanButtons must report the activity while a button is pressed or
+ *        once after an encoder step.
+*/
+ZTEST(buttonMngr_suite, test_scanButtons_Activity)
+{
+  atomic_set(&inputBits, 0);
+  matrixRaw = 0;
+  testPortValue = 0;
+  gpioPortRead_fake.custom_fake = customEncPortRead;
+
+  zassert_false(scanButtons(TEST_SCAN_CYCLE));
+
+  addEncoderSteps(encoders + ABS_ENC_IDX, -1);
+  zassert_true(scanButtons(TEST_SCAN_CYCLE));
+  zassert_false(scanButtons(TEST_SCAN_CYCLE));
+
+  debounceUpdate_fake.custom_fake = customShifterPressed;
+  zassert_true(scanButtons(TEST_SCAN_CYCLE));
+  zassert_equal(BIT(LEFT_SHIFTER_IDX), atomic_get(&inputBits));
+}
+
+/**
+ * @test  notifySubscribers must not wait on a full subscriber queue and
+ *        must still post to the other subscribers.
+*/
+ZTEST(buttonMngr_suite, test_notifySubscribers_FullQueue)
+{
+  ButtonMngrEvent event;
+
+  zassert_equal(0, buttonMngrSubscribe(&testSmallQueue));
+  zassert_equal(0, buttonMngrSubscribe(&testEventQueue));
+
+  notifySubscribers(TEST_SCAN_CYCLE);
+  pressEncoderButton(TC_DEC_IDX);
+  notifySubscribers(TEST_SCAN_CYCLE);
+
+  zassert_equal(1, k_msgq_num_used_get(&testSmallQueue));
+  zassert_equal(2, k_msgq_num_used_get(&testEventQueue));
+  zassert_equal(0, k_msgq_get(&testSmallQueue, &event, K_NO_WAIT));
+  zassert_equal(TEST_INPUT_BITS, event.states);
+}
+
+/**
+ * @test  buttonMngrInitCursor must skip the encoder presses that happened
+ *        before.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrInitCursor_SkipPastPresses)
+{
+  ButtonMngrCursor cursor;
+
+  pressEncoderButton(TC_INC_IDX);
+  buttonMngrInitCursor(&cursor);
+
+  zassert_equal(TEST_INPUT_BITS, buttonMngrReadCursor(&cursor));
+}
+
+/**
+ * @test  buttonMngrReadCursor must report every encoder press once to each
+ *        consumer, independently of the other consumers and of the
+ *        snapshot readers.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrReadCursor_IndependentConsumers)
+{
+  ButtonMngrCursor usbCursor;
+  ButtonMngrCursor ledCursor;
+  WheelButtonBits expected = TEST_INPUT_BITS | BIT64(ABS_INC_IDX);
+
+  buttonMngrInitCursor(&usbCursor);
+  buttonMngrInitCursor(&ledCursor);
+
+  pressEncoderButton(ABS_INC_IDX);
+  buttonMngrGetSnapshot();
+
+  zassert_equal(expected, buttonMngrReadCursor(&usbCursor));
+  zassert_equal(TEST_INPUT_BITS, buttonMngrReadCursor(&usbCursor));
+
+  pressEncoderButton(BB_DEC_IDX);
+  zassert_equal(expected | BIT64(BB_DEC_IDX), buttonMngrReadCursor(&ledCursor));
+  zassert_equal(TEST_INPUT_BITS | BIT64(BB_DEC_IDX),
+    buttonMngrReadCursor(&usbCursor));
+  zassert_equal(TEST_INPUT_BITS, buttonMngrReadCursor(&ledCursor));
+}
+
+/**
+ * @test  buttonMngrGetEncoderSteps must return the error code when the
+ *        encoder index is invalid.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrGetEncoderSteps_BadEncoder)
+{
+  int failRet = -EINVAL;
+  int32_t steps;
+
+  zassert_equal(failRet, buttonMngrGetEncoderSteps(ENCODER_COUNT, &steps));
+}
+
+/**
+ * @test  buttonMngrGetEncoderSteps must return the success code, the steps
+ *        counted since the last call and reset the counter.
+*/
+ZTEST(buttonMngr_suite, test_buttonMngrGetEncoderSteps_Success)
+{
+  int successRet = 0;
+  int32_t steps;
+  int32_t expectedSteps[ENCODER_COUNT] = {1, -1, 12, -7, 0, 3};
+
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
+  {
+    atomic_set(encSteps + i, expectedSteps[i]);
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+    /* slow enough not to be accelerated */
+    encoders[i].stepPeriod = k_ms_to_cyc_near32(MSEC_PER_SEC);
+#endif
+  }
+
+  for(uint8_t i = 0; i < ENCODER_COUNT; ++i)
+  {
+    zassert_equal(successRet, buttonMngrGetEncoderSteps(i, &steps));
+    zassert_equal(expectedSteps[i], steps);
+    zassert_equal(successRet, buttonMngrGetEncoderSteps(i, &steps));
+    zassert_equal(0, steps);
+  }
+}
+
+#ifdef CONFIG_BUTTON_MNGR_ENC_ACCEL
+#define ACCEL_FACTOR_TEST_CNT       5
+/**
+ * @test  getAccelFactor must return 1 up to the start rate, the maximal
+ *        factor from the full acceleration rate and a linear factor between.
+*/
+ZTEST(buttonMngr_suite, test_getAccelFactor_Curve)
+{
+  uint32_t minRate = CONFIG_BUTTON_MNGR_ENC_ACCEL_MIN_RATE;
+  uint32_t maxRate = CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_RATE;
+  uint32_t maxFactor = CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_FACTOR;
+  uint32_t rates[ACCEL_FACTOR_TEST_CNT] = {0, minRate, (minRate + maxRate) / 2,
+                                           maxRate, UINT32_MAX};
+  uint32_t expectedFactors[ACCEL_FACTOR_TEST_CNT] =
+    {1, 1, 1 + (maxFactor - 1) * ((minRate + maxRate) / 2 - minRate) /
+     (maxRate - minRate), maxFactor, maxFactor};
+
+  for(uint8_t i = 0; i < ACCEL_FACTOR_TEST_CNT; ++i)
+    zassert_equal(expectedFactors[i], getAccelFactor(rates[i]));
+}
+
+/**
+ * @test  accelerateSteps must compute the step rate from the last step
+ *        period and multiply the steps by the acceleration factor.
+*/
+ZTEST(buttonMngr_suite, test_accelerateSteps_ApplyFactor)
+{
+  EncoderDesc *enc = encoders + RIGHT_ENC_IDX;
+
+  zassert_equal(0, accelerateSteps(enc, 0));
+
+  /* 2 steps/s: not accelerated */
+  enc->stepPeriod = k_ms_to_cyc_near32(MSEC_PER_SEC / 2);
+  zassert_equal(-2, accelerateSteps(enc, -2));
+
+  /* 1000 steps/s: fully accelerated */
+  enc->stepPeriod = k_ms_to_cyc_near32(1);
+  zassert_equal(10 * CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_FACTOR,
+    accelerateSteps(enc, 10));
+}
+
+/**
+ * @test  addEncoderSteps must timestamp the steps and measure their period.
+*/
+ZTEST(buttonMngr_suite, test_addEncoderSteps_Timestamp)
+{
+  uint32_t before = k_cycle_get_32();
+
+  addEncoderSteps(encoders + TC_ENC_IDX, 1);
+  zassert_true(encoders[TC_ENC_IDX].stepCycle - before <=
+    k_cycle_get_32() - before);
+}
 
-  for(uint8_t i = TC_INC_IDX; i < BUTTON_COUNT; ++i)
-    zassert_equal(BUTTON_DEPRESSED, buttonStates[i]);
+/**
+ * @test  A fast flick after a pause must be accelerated from its own step
+ *        period, however long the pause since the previous read.
+*/
+ZTEST(buttonMngr_suite, test_addEncoderSteps_AccelAfterPause)
+{
+  EncoderDesc *enc = encoders + RIGHT_ENC_IDX;
+  uint32_t stepPeriod = k_ms_to_cyc_near32(2);
+  uint32_t before;
+  int32_t steps;
+
+  /* the previous step 10 s ago */
+  enc->stepCycle = k_cycle_get_32() - k_ms_to_cyc_near32(10 * MSEC_PER_SEC);
+  addEncoderSteps(enc, 1);
+  zassert_true(enc->stepPeriod >= k_ms_to_cyc_near32(10 * MSEC_PER_SEC));
+
+  /* the flick, one step every 2 ms */
+  before = k_cycle_get_32();
+  enc->stepCycle = before - stepPeriod;
+  addEncoderSteps(enc, 1);
+  zassert_true(enc->stepPeriod - stepPeriod <= k_cycle_get_32() - before);
+
+  zassert_equal(0, buttonMngrGetEncoderSteps(RIGHT_ENC_IDX, &steps));
+  zassert_equal(2 * CONFIG_BUTTON_MNGR_ENC_ACCEL_MAX_FACTOR, steps);
 }
+#endif
 
 /** @} */
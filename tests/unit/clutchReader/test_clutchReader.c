@@ -22,6 +22,7 @@
 #include "clutchReader.h"
 #include "clutchReader.c"
 
+#include "signalFilter.h"
 #include "zephyrAdc.h"
 #include "zephyrCommon.h"
 #include "zephyrThread.h"
@@ -33,8 +34,58 @@ FAKE_VALUE_FUNC(int, zephyrAdcInit, ZephyrAdcChanConfig*, size_t, ZephyrAdcRes,
   uint32_t);
 FAKE_VALUE_FUNC(int, zephyrAdcGetSample, uint32_t, uint32_t*);
 FAKE_VALUE_FUNC(uint32_t, zephyrThreadSleepMs, uint32_t);
+FAKE_VALUE_FUNC(int, signalFilterInit, SignalFilter*,
+                const SignalFilterConfig*);
+FAKE_VALUE_FUNC(uint32_t, signalFilterUpdate, SignalFilter*, uint32_t);
 FAKE_VOID_FUNC(zephyrThreadCreate, ZephyrThread*, char*, uint32_t,
                ZephyrTimeUnit);
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+FAKE_VALUE_FUNC(int, testAdcReadAsync, const struct device*,
+                const struct adc_sequence*, struct k_poll_signal*);
+
+/**
+ * @brief The test ADC driver API.
+*/
+static const struct adc_driver_api testAdcApi = {
+  .read_async = testAdcReadAsync,
+};
+
+/**
+ * @brief The test ADC device.
+*/
+static const struct device testAdcDev = {
+  .name = "testAdc",
+  .api = &testAdcApi,
+};
+#endif
+
+/**
+ * @brief The calibration save return value, the settings have no storage
+ *        backend in the test.
+*/
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+#define TEST_CALIB_SAVE_RET               -ENOENT
+#else
+#define TEST_CALIB_SAVE_RET               0
+#endif
+
+/**
+ * @brief The test calibration low raw values.
+*/
+static const uint32_t testCalibLows[CLUTCH_READER_CHAN_CNT] = {400, 600};
+
+/**
+ * @brief The test calibration high raw values.
+*/
+static const uint32_t testCalibHighs[CLUTCH_READER_CHAN_CNT] = {3000, 3500};
+
+/**
+ * @brief The signalFilterUpdate custom fake passing the samples through.
+*/
+static uint32_t customSignalFilterUpdate(SignalFilter *filter, uint32_t sample)
+{
+  return sample;
+}
 
 /**
  * @brief   Clutch reader test cases setup.
@@ -47,6 +98,27 @@ static void clutchReaderCaseSetup(void *f)
   RESET_FAKE(zephyrAdcGetSample);
   RESET_FAKE(zephyrThreadSleepMs);
   RESET_FAKE(zephyrThreadCreate);
+  RESET_FAKE(signalFilterInit);
+  RESET_FAKE(signalFilterUpdate);
+
+  signalFilterUpdate_fake.custom_fake = customSignalFilterUpdate;
+
+  clutchReaderCancelCalib();
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    setRawLimits(i, testCalibLows[i], testCalibHighs[i]);
+#if defined(CONFIG_CLUTCH_READER_AUTO_CALIB) && \
+    defined(CONFIG_CLUTCH_READER_CALIB_STORE)
+  resetSavedLimits();
+  autoCalibWidened = false;
+#endif
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+  RESET_FAKE(testAdcReadAsync);
+
+  adcDev = &testAdcDev;
+  atomic_clear(&streamHead);
+  streamTail = 0;
+  k_poll_signal_init(&streamSignal);
+#endif
 }
 
 ZTEST_SUITE(clutchReader_suite, NULL, NULL, clutchReaderCaseSetup, NULL, NULL);
@@ -93,6 +165,7 @@ int customZephyrAdcInitSuccess(ZephyrAdcChanConfig *configs, size_t configCount,
   return 0;
 }
 
+#ifndef CONFIG_CLUTCH_READER_ADC_STREAM
 #define CLUTCH_SAMPLE_TEST_CNT            2
 /**
  * @test  sampleClutchRawValues must return the error code if any of the
@@ -118,7 +191,124 @@ ZTEST(clutchReader_suite, test_sampleClutchRawValues_SamplingFail)
 
     RESET_FAKE(zephyrAdcGetSample);
   }
+
+  zassert_equal(0, signalFilterUpdate_fake.call_count);
+}
+
+/**
+ * @test  sampleClutchRawValues must feed each channel sample to its filter
+ *        and return the filtered values.
+*/
+ZTEST(clutchReader_suite, test_sampleClutchRawValues_Filter)
+{
+  int successRet = 0;
+  uint32_t samples[CLUTCH_READER_CHAN_CNT];
+
+  zassert_equal(successRet, sampleClutchRawValues(samples));
+  zassert_equal(CLUTCH_READER_CHAN_CNT, signalFilterUpdate_fake.call_count);
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    zassert_equal(filters + i, signalFilterUpdate_fake.arg0_history[i]);
+}
+
+#else
+/**
+ * @test  streamCallback must copy the sample set to the stream ring and
+ *        request the sampling to be repeated.
+*/
+ZTEST(clutchReader_suite, test_streamCallback_CopyAndRepeat)
+{
+  uint16_t samples[CLUTCH_READER_CHAN_CNT] = {1234, 2345};
+  struct adc_sequence sequence = {.buffer = samples};
+
+  for(uint8_t i = 0; i < CLUTCH_READER_STREAM_DEPTH + 1; ++i)
+  {
+    samples[0] = 1234 + i;
+    zassert_equal(ADC_ACTION_REPEAT,
+      streamCallback(&testAdcDev, &sequence, 0));
+    zassert_equal(i + 1, atomic_get(&streamHead));
+    zassert_equal(1234 + i, streamRing[i % CLUTCH_READER_STREAM_DEPTH][0]);
+    zassert_equal(2345, streamRing[i % CLUTCH_READER_STREAM_DEPTH][1]);
+  }
+}
+
+/**
+ * @test  readStreamValues must return -EAGAIN until a sample set is
+ *        available, then the latest sample set.
+*/
+ZTEST(clutchReader_suite, test_readStreamValues_LatestSet)
+{
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT];
+  uint16_t samples[CLUTCH_READER_CHAN_CNT] = {100, 200};
+  struct adc_sequence sequence = {.buffer = samples};
+
+  zassert_equal(-EAGAIN, sampleClutchRawValues(rawValues));
+
+  streamCallback(&testAdcDev, &sequence, 0);
+  samples[0] = 300;
+  samples[1] = 400;
+  streamCallback(&testAdcDev, &sequence, 0);
+
+  zassert_equal(0, sampleClutchRawValues(rawValues));
+  zassert_equal(300, rawValues[0]);
+  zassert_equal(400, rawValues[1]);
+  zassert_equal(2 * CLUTCH_READER_CHAN_CNT,
+    signalFilterUpdate_fake.call_count);
+  zassert_equal(100, signalFilterUpdate_fake.arg1_history[0]);
+  zassert_equal(0, testAdcReadAsync_fake.call_count);
+
+  zassert_equal(-EAGAIN, sampleClutchRawValues(rawValues));
+}
+
+/**
+ * @test  readStreamValues must only filter the sample sets not overwritten
+ *        yet.
+*/
+ZTEST(clutchReader_suite, test_readStreamValues_SkipOverwritten)
+{
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT];
+  uint16_t samples[CLUTCH_READER_CHAN_CNT] = {0, 0};
+  struct adc_sequence sequence = {.buffer = samples};
+
+  for(uint8_t i = 0; i < 2 * CLUTCH_READER_STREAM_DEPTH; ++i)
+  {
+    samples[0] = i;
+    streamCallback(&testAdcDev, &sequence, 0);
+  }
+
+  zassert_equal(0, readStreamValues(rawValues));
+  zassert_equal(CLUTCH_READER_CHAN_CNT * (CLUTCH_READER_STREAM_DEPTH - 1),
+    signalFilterUpdate_fake.call_count);
+  zassert_equal(CLUTCH_READER_STREAM_DEPTH + 1,
+    signalFilterUpdate_fake.arg1_history[0]);
+  zassert_equal(2 * CLUTCH_READER_STREAM_DEPTH - 1, rawValues[0]);
+  zassert_equal(2 * CLUTCH_READER_STREAM_DEPTH, streamTail);
+}
+
+/**
+ * @test  readStreamValues must restart the stream once stopped and return
+ *        the error code if the restart fails.
+*/
+ZTEST(clutchReader_suite, test_readStreamValues_Restart)
+{
+  int failRet = -EIO;
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT];
+
+  k_poll_signal_raise(&streamSignal, -EIO);
+  testAdcReadAsync_fake.return_val = failRet;
+
+  zassert_equal(failRet, readStreamValues(rawValues));
+  zassert_equal(1, testAdcReadAsync_fake.call_count);
+  zassert_equal(&testAdcDev, testAdcReadAsync_fake.arg0_val);
+  zassert_equal(&streamSequence, testAdcReadAsync_fake.arg1_val);
+  zassert_equal(&streamSignal, testAdcReadAsync_fake.arg2_val);
+
+  testAdcReadAsync_fake.return_val = 0;
+  k_poll_signal_raise(&streamSignal, -EIO);
+
+  zassert_equal(-EAGAIN, readStreamValues(rawValues));
+  zassert_equal(2, testAdcReadAsync_fake.call_count);
 }
+#endif
 
 #define CLUTCH_CALC_STATE_TEST_CNT        6
 /**
@@ -139,23 +329,412 @@ ZTEST(clutchReader_suite, test_calculateClutchState_CalcClutchState)
   uint8_t frictPoints[CLUTCH_CALC_STATE_TEST_CNT] = {127, 127,
                                                      127, 200,
                                                      127, 127};
-  uint8_t expectedStates[CLUTCH_CALC_STATE_TEST_CNT] = {255, 255,
+  uint8_t expectedStates[CLUTCH_CALC_STATE_TEST_CNT] = {32, 127,
                                                         127, 200,
                                                         95, 0};
+  ClutchStatus status;
+  ClutchCurve curve;
+
+  zassert_equal(0, clutchReaderBuildCurve(CLUTCH_CURVE_LINEAR, 0, 0, &curve));
+  zassert_equal(0, clutchReaderSetCurve(&curve));
 
   for(uint8_t i = 0; i < CLUTCH_CALC_STATE_TEST_CNT; ++i)
   {
     for(uint8_t j = 0; j < CLUTCH_READER_CHAN_CNT; ++j)
-    {
-      rawLimits[j][0] = testRawLimits[i][j][0];
-      rawLimits[j][1] = testRawLimits[i][j][1];
-    }
+      setRawLimits(j, testRawLimits[i][j][0], testRawLimits[i][j][1]);
 
-    result = calculateClutchState(rawValues[i], frictPoints[i]);
+    result = calculateClutchState(rawValues[i], frictPoints[i], &status);
 
     zassert_equal(expectedStates[i], result);
+    zassert_equal(CLUTCH_STATUS_OK, status);
+  }
+}
+
+#define CLUTCH_FUSION_TEST_CNT            9
+/**
+ * @test  calculateClutchState must fuse both paddles smoothly and ignore the
+ *        implausible ones.
+*/
+ZTEST(clutchReader_suite, test_calculateClutchState_FusePaddles)
+{
+  uint32_t rawValues[CLUTCH_FUSION_TEST_CNT][CLUTCH_READER_CHAN_CNT] =
+    {{3000, 3000}, {1000, 3000}, {1000, 1000}, {2000, 3000}, {1000, 2000},
+     {2000, 2000}, {100, 3000}, {1000, 4000}, {100, 4000}};
+  uint8_t expectedStates[CLUTCH_FUSION_TEST_CNT] = {0, 127, 255, 63, 191,
+                                                    127, 0, 127, 0};
+  ClutchStatus expectedStatus[CLUTCH_FUSION_TEST_CNT] =
+    {CLUTCH_STATUS_OK, CLUTCH_STATUS_OK, CLUTCH_STATUS_OK, CLUTCH_STATUS_OK,
+     CLUTCH_STATUS_OK, CLUTCH_STATUS_OK, CLUTCH_STATUS_DEGRADED,
+     CLUTCH_STATUS_DEGRADED, CLUTCH_STATUS_FAULT};
+  ClutchStatus status;
+  ClutchCurve curve;
+
+  zassert_equal(0, clutchReaderBuildCurve(CLUTCH_CURVE_LINEAR, 0, 0, &curve));
+  zassert_equal(0, clutchReaderSetCurve(&curve));
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    setRawLimits(i, 1000, 3000);
+
+  for(uint8_t i = 0; i < CLUTCH_FUSION_TEST_CNT; ++i)
+  {
+    zassert_equal(expectedStates[i],
+      calculateClutchState(rawValues[i], 127, &status));
+    zassert_equal(expectedStatus[i], status);
+  }
+}
+
+/**
+ * @test  setRawLimits must derive the raw value to travel scale, released
+ *        being no travel whatever the direction of the raw values.
+*/
+ZTEST(clutchReader_suite, test_setRawLimits_TravelScale)
+{
+  setRawLimits(0, 1000, 3000);
+  setRawLimits(1, 3000, 1000);
+
+  zassert_equal(CLUTCH_TRAVEL_MAX, getClutchTravel(0, 1000));
+  zassert_equal(CLUTCH_TRAVEL_MAX / 2, getClutchTravel(0, 2000));
+  zassert_equal(0, getClutchTravel(0, 3000));
+  zassert_equal(0, getClutchTravel(0, 3500));
+  zassert_equal(CLUTCH_TRAVEL_MAX, getClutchTravel(0, 500));
+  zassert_equal(CLUTCH_TRAVEL_MAX, getClutchTravel(1, 3000));
+  zassert_equal(CLUTCH_TRAVEL_MAX / 4, getClutchTravel(1, 1500));
+  zassert_equal(0, getClutchTravel(1, 900));
+}
+
+#define CLUTCH_CURVE_TEST_CNT             5
+/**
+ * @test  applyClutchCurve must cut off the deadzones and interpolate the
+ *        travel between the curve points.
+*/
+ZTEST(clutchReader_suite, test_applyClutchCurve_DeadzonesAndInterpolation)
+{
+  ClutchCurve curve;
+  uint32_t travels[CLUTCH_CURVE_TEST_CNT] = {0, 409, 2048, 3687,
+                                             CLUTCH_TRAVEL_MAX};
+  uint32_t expected[CLUTCH_CURVE_TEST_CNT] = {0, 0, 16383, 65535, 65535};
+
+  zassert_equal(0, clutchReaderBuildCurve(CLUTCH_CURVE_PROGRESSIVE, 10, 10,
+                                          &curve));
+  zassert_equal(0, clutchReaderSetCurve(&curve));
+
+  for(uint8_t i = 0; i < CLUTCH_CURVE_TEST_CNT; ++i)
+    zassert_equal(expected[i], applyClutchCurve(travels[i]));
+
+  /* between two points */
+  zassert_equal(0, clutchReaderBuildCurve(CLUTCH_CURVE_LINEAR, 0, 0, &curve));
+  zassert_equal(0, clutchReaderSetCurve(&curve));
+  zassert_equal(curve.points[1] + (curve.points[2] - curve.points[1]) / 2,
+    applyClutchCurve(3 << (CLUTCH_CURVE_SEGMENT_SHIFT - 1)));
+}
+
+/**
+ * @test  clutchReaderBuildCurve must build monotonic curves from the released
+ *        output to the friction point and reject the invalid parameters.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderBuildCurve_Shapes)
+{
+  ClutchCurve curve;
+  uint16_t middles[CLUTCH_CURVE_SHAPE_COUNT] = {32767, 16383, 49152};
+
+  for(uint8_t shape = 0; shape < CLUTCH_CURVE_SHAPE_COUNT; ++shape)
+  {
+    zassert_equal(0, clutchReaderBuildCurve(shape, 5, 10, &curve));
+    zassert_equal(0, curve.points[0]);
+    zassert_equal(middles[shape], curve.points[CLUTCH_CURVE_POINT_CNT / 2]);
+    zassert_equal(CLUTCH_CURVE_POINT_MAX,
+      curve.points[CLUTCH_CURVE_POINT_CNT - 1]);
+    zassert_equal(5, curve.lowDeadzone);
+    zassert_equal(10, curve.highDeadzone);
+  }
+
+  zassert_equal(-EINVAL, clutchReaderBuildCurve(CLUTCH_CURVE_SHAPE_COUNT, 0, 0,
+                                                &curve));
+  zassert_equal(-EINVAL, clutchReaderBuildCurve(CLUTCH_CURVE_LINEAR,
+                                                CLUTCH_CURVE_DEADZONE_MAX + 1,
+                                                0, &curve));
+}
+
+/**
+ * @test  clutchReaderSetCurve must reject the decreasing curves and the
+ *        oversized deadzones.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderSetCurve_Invalid)
+{
+  ClutchCurve curve;
+
+  zassert_equal(0, clutchReaderBuildCurve(CLUTCH_CURVE_LINEAR, 0, 0, &curve));
+  curve.points[4] = curve.points[3] - 1;
+  zassert_equal(-EINVAL, clutchReaderSetCurve(&curve));
+
+  zassert_equal(0, clutchReaderBuildCurve(CLUTCH_CURVE_LINEAR, 0, 0, &curve));
+  curve.highDeadzone = CLUTCH_CURVE_DEADZONE_MAX + 1;
+  zassert_equal(-EINVAL, clutchReaderSetCurve(&curve));
+}
+
+/**
+ * @test  clutchReaderStopCalib must apply the tracked raw range shrunk by the
+ *        calibration margin.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderStopCalib_ApplyRange)
+{
+  uint32_t pressed;
+  uint32_t released;
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT];
+  uint32_t lows[CLUTCH_READER_CHAN_CNT] = {100, 50};
+  uint32_t highs[CLUTCH_READER_CHAN_CNT] = {3900, 4000};
+
+  zassert_equal(0, clutchReaderStartCalib());
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    rawValues[i] = lows[i];
+  trackClutchRange(rawValues);
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    rawValues[i] = highs[i];
+  trackClutchRange(rawValues);
+
+  zassert_equal(TEST_CALIB_SAVE_RET, clutchReaderStopCalib());
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    zassert_equal(0, clutchReaderGetLimits(i, &pressed, &released));
+    zassert_equal(lows[i] + CLUTCH_CALIB_MARGIN, pressed);
+    zassert_equal(highs[i] - CLUTCH_CALIB_MARGIN, released);
+  }
+
+  zassert_equal(-EINVAL, clutchReaderStopCalib());
+}
+
+/**
+ * @test  clutchReaderStopCalib must reject a paddle travel too short and keep
+ *        the raw limits.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderStopCalib_TravelTooShort)
+{
+  uint32_t pressed;
+  uint32_t released;
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT] = {1000, 1000};
+
+  zassert_equal(0, clutchReaderStartCalib());
+  trackClutchRange(rawValues);
+  rawValues[0] = 1000 + CLUTCH_CALIB_MIN_SPAN + 2 * CLUTCH_CALIB_MARGIN;
+  rawValues[1] = 1000 + CLUTCH_CALIB_MIN_SPAN;
+  trackClutchRange(rawValues);
+
+  zassert_equal(-ERANGE, clutchReaderStopCalib());
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    zassert_equal(0, clutchReaderGetLimits(i, &pressed, &released));
+    zassert_equal(testCalibLows[i], pressed);
+    zassert_equal(testCalibHighs[i], released);
+  }
+}
+
+/**
+ * @test  clutchReaderCancelCalib must stop the tracking without applying it.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderCancelCalib_NoTracking)
+{
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT] = {0, 4095};
+
+  zassert_equal(0, clutchReaderStartCalib());
+  clutchReaderCancelCalib();
+  trackClutchRange(rawValues);
+
+  zassert_equal(UINT32_MAX, trackMin[0]);
+  zassert_equal(-EINVAL, clutchReaderStopCalib());
+}
+
+/**
+ * @test  clutchReaderGetLimits must return the error code for an invalid
+ *        channel.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderGetLimits_InvalidChannel)
+{
+  uint32_t pressed;
+  uint32_t released;
+
+  zassert_equal(-EINVAL, clutchReaderGetLimits(CLUTCH_READER_CHAN_CNT,
+                                               &pressed, &released));
+}
+
+#ifdef CONFIG_CLUTCH_READER_AUTO_CALIB
+/**
+ * @test  autoCalibrate must widen the range at once and decay it inward once
+ *        per decay period.
+*/
+ZTEST(clutchReader_suite, test_autoCalibrate_WidenAndDecay)
+{
+  uint32_t pressed;
+  uint32_t released;
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT] = {300, 2000};
+
+  lastDecayMs = k_uptime_get();
+  autoCalibrate(rawValues);
+
+  zassert_equal(0, clutchReaderGetLimits(0, &pressed, &released));
+  zassert_equal(300 + CLUTCH_CALIB_MARGIN, pressed);
+  zassert_equal(testCalibHighs[0], released);
+  zassert_equal(0, clutchReaderGetLimits(1, &pressed, &released));
+  zassert_equal(testCalibLows[1], pressed);
+  zassert_equal(testCalibHighs[1], released);
+
+  lastDecayMs = k_uptime_get() - CONFIG_CLUTCH_READER_CALIB_DECAY_MS;
+  autoCalibrate(rawValues);
+
+  zassert_equal(0, clutchReaderGetLimits(1, &pressed, &released));
+  zassert_equal(testCalibLows[1] + 1, pressed);
+  zassert_equal(testCalibHighs[1] - 1, released);
+}
+
+/**
+ * @test  autoCalibrate must not widen the range to an implausible value, as
+ *        read from an open or shorted sensor.
+*/
+ZTEST(clutchReader_suite, test_autoCalibrate_IgnoreImplausible)
+{
+  uint32_t pressed;
+  uint32_t released;
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT] = {0, 4095 << CLUTCH_SCALE_BITS};
+
+  lastDecayMs = k_uptime_get();
+  autoCalibrate(rawValues);
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    zassert_equal(0, clutchReaderGetLimits(i, &pressed, &released));
+    zassert_equal(testCalibLows[i], pressed);
+    zassert_equal(testCalibHighs[i], released);
+  }
+}
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+/**
+ * @test  autoCalibrate must keep a widening unsaved until the save period
+ *        elapsed, then hand it to the save work instead of saving it from
+ *        the clutch thread.
+*/
+ZTEST(clutchReader_suite, test_autoCalibrate_DeferSave)
+{
+  struct k_work_sync sync;
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT] = {300, 2000};
+
+  lastDecayMs = k_uptime_get();
+  lastSaveMs = k_uptime_get();
+  autoCalibrate(rawValues);
+
+  zassert_true(autoCalibWidened);
+  zassert_false(k_work_is_pending(&autoCalibSaveWork));
+  zassert_equal(testCalibLows[0], savedLimits[0][0]);
+
+  lastSaveMs = k_uptime_get() -
+    CONFIG_CLUTCH_READER_CALIB_SAVE_S * MSEC_PER_SEC;
+  autoCalibrate(rawValues);
+
+  zassert_false(autoCalibWidened);
+  zassert_equal(300 + CLUTCH_CALIB_MARGIN, savedLimits[0][0]);
+  zassert_equal(testCalibHighs[0], savedLimits[0][1]);
+  zassert_equal(testCalibLows[1], savedLimits[1][0]);
+  zassert_equal(testCalibHighs[1], savedLimits[1][1]);
+  k_work_flush(&autoCalibSaveWork, &sync);
+}
+
+/**
+ * @test  autoCalibrate must not save a widening within the save threshold.
+*/
+ZTEST(clutchReader_suite, test_autoCalibrate_SmallWidenUnsaved)
+{
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT] = {
+    testCalibLows[0] - CLUTCH_CALIB_MARGIN - CLUTCH_CALIB_SAVE_DELTA, 2000};
+
+  lastDecayMs = k_uptime_get();
+  lastSaveMs = k_uptime_get() -
+    CONFIG_CLUTCH_READER_CALIB_SAVE_S * MSEC_PER_SEC;
+  autoCalibrate(rawValues);
+
+  zassert_false(autoCalibWidened);
+  zassert_false(k_work_is_pending(&autoCalibSaveWork));
+  zassert_equal(testCalibLows[0], savedLimits[0][0]);
+}
+
+/**
+ * @test  autoCalibrate must never save the decayed raw limits.
+*/
+ZTEST(clutchReader_suite, test_autoCalibrate_DecayUnsaved)
+{
+  uint32_t pressed;
+  uint32_t released;
+  uint32_t rawValues[CLUTCH_READER_CHAN_CNT] = {2000, 2000};
+
+  lastSaveMs = k_uptime_get() -
+    CONFIG_CLUTCH_READER_CALIB_SAVE_S * MSEC_PER_SEC;
+  for(uint8_t i = 0; i < 4; ++i)
+  {
+    lastDecayMs = k_uptime_get() - CONFIG_CLUTCH_READER_CALIB_DECAY_MS;
+    autoCalibrate(rawValues);
+  }
+
+  zassert_equal(0, clutchReaderGetLimits(0, &pressed, &released));
+  zassert_equal(testCalibLows[0] + 4, pressed);
+  zassert_false(autoCalibWidened);
+  zassert_false(k_work_is_pending(&autoCalibSaveWork));
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    zassert_equal(testCalibLows[i], savedLimits[i][0]);
+    zassert_equal(testCalibHighs[i], savedLimits[i][1]);
+  }
+}
+#endif
+#endif
+
+#ifdef CONFIG_CLUTCH_READER_CALIB_STORE
+/**
+ * @brief The test saved calibration.
+*/
+static ClutchCalibData testCalibData;
+
+/**
+ * @brief The settings read callback of the test saved calibration.
+*/
+static ssize_t testCalibRead(void *cbArg, void *data, size_t len)
+{
+  ARG_UNUSED(cbArg);
+
+  memcpy(data, &testCalibData, len);
+
+  return len;
+}
+
+/**
+ * @test  setCalibration must load the saved raw limits rescaled to the
+ *        current oversampling and reject the invalid entries.
+*/
+ZTEST(clutchReader_suite, test_setCalibration_LoadLimits)
+{
+  uint32_t pressed;
+  uint32_t released;
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    testCalibData.limits[i][0] = 100 + i;
+    testCalibData.limits[i][1] = 3000 + i;
+  }
+  testCalibData.scaleBits = 0;
+
+  zassert_equal(-ENOENT, setCalibration("other", sizeof(testCalibData),
+                                        testCalibRead, NULL));
+  zassert_equal(-EINVAL, setCalibration(CLUTCH_SETTINGS_LIMITS_KEY, 1,
+                                        testCalibRead, NULL));
+  zassert_equal(0, setCalibration(CLUTCH_SETTINGS_LIMITS_KEY,
+                                  sizeof(testCalibData), testCalibRead,
+                                  NULL));
+
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+  {
+    zassert_equal(0, clutchReaderGetLimits(i, &pressed, &released));
+    zassert_equal((100 + i) << CLUTCH_SCALE_BITS, pressed);
+    zassert_equal((3000 + i) << CLUTCH_SCALE_BITS, released);
   }
 }
+#endif
 
 /**
  * @test  clutchReaderInit must return the error code when initializing the
@@ -171,6 +750,40 @@ ZTEST(clutchReader_suite, test_clutchReaderInit_AdcInitFail)
   zassert_equal(1, zephyrAdcInit_fake.call_count);
 }
 
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+/**
+ * @test  clutchReaderInit must return the error code when starting the clutch
+ *        stream fails.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderInit_StreamStartFail)
+{
+  int failRet = -EBUSY;
+
+  zephyrAdcInit_fake.custom_fake = customZephyrAdcInitSuccess;
+  testAdcReadAsync_fake.return_val = failRet;
+
+  zassert_equal(failRet, clutchReaderInit());
+  zassert_equal(1, testAdcReadAsync_fake.call_count);
+  zassert_equal(0, zephyrThreadCreate_fake.call_count);
+}
+#endif
+
+/**
+ * @test  clutchReaderInit must return the error code when the clutch filter
+ *        configuration is invalid.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderInit_FilterInitFail)
+{
+  int failRet = -EINVAL;
+
+  zephyrAdcInit_fake.custom_fake = customZephyrAdcInitSuccess;
+  signalFilterInit_fake.return_val = failRet;
+
+  zassert_equal(failRet, clutchReaderInit());
+  zassert_equal(1, signalFilterInit_fake.call_count);
+  zassert_equal(0, zephyrThreadCreate_fake.call_count);
+}
+
 /**
  * @test  clutchReaderInit must return the success code when initializing the
  *        ADC and the reading thread succeeds.
@@ -183,15 +796,36 @@ ZTEST(clutchReader_suite, test_clutchReaderInit_AdcInitSuccess)
 
   zassert_equal(successRet, clutchReaderInit());
   zassert_equal(1, zephyrAdcInit_fake.call_count);
+  zassert_equal(CLUTCH_READER_CHAN_CNT, signalFilterInit_fake.call_count);
+  for(uint8_t i = 0; i < CLUTCH_READER_CHAN_CNT; ++i)
+    zassert_equal(filters + i, signalFilterInit_fake.arg0_history[i]);
   zassert_equal(1, zephyrThreadCreate_fake.call_count);
   zassert_equal(&thread, zephyrThreadCreate_fake.arg0_val);
   zassert_equal(CLUTCH_READER_THREAD_NAME, zephyrThreadCreate_fake.arg1_val);
   zassert_equal(ZEPHYR_TIME_NO_WAIT, zephyrThreadCreate_fake.arg2_val);
   zassert_equal(MILLI_SEC, zephyrThreadCreate_fake.arg3_val);
   zassert_equal(clutchReaderThread, thread.entry);
+#ifdef CONFIG_CLUTCH_READER_ADC_STREAM
+  zassert_equal(1, testAdcReadAsync_fake.call_count);
+  zassert_equal(&streamSequence, testAdcReadAsync_fake.arg1_val);
+#endif
 }
 
 #define CLUTCH_GET_STATE_TEST_CNT         3
+/**
+ * @test  clutchReaderGetStatus must return the current clutch status.
+*/
+ZTEST(clutchReader_suite, test_clutchReaderGetStatus_ClutchStatus)
+{
+  for(ClutchStatus status = CLUTCH_STATUS_OK; status <= CLUTCH_STATUS_FAULT;
+      ++status)
+  {
+    clutchStatus = status;
+
+    zassert_equal(status, clutchReaderGetStatus());
+  }
+}
+
 /**
  * @test  clutchReaderGetState must return the current clutch state.
 */
@@ -27,6 +27,24 @@ macro(getFileListForSuite sourceList includeList)
     listIncludesDir(${CMAKE_CURRENT_SOURCE_DIR}/../../src modInc)
   endif()
 
+  if(TEST_SUITE STREQUAL "signalFilter")
+    listSources(${CMAKE_CURRENT_SOURCE_DIR}/signalFilter testSrc)
+    listIncludesDir(${CMAKE_CURRENT_SOURCE_DIR}/signalFilter testInc)
+    listIncludesDir(${CMAKE_CURRENT_SOURCE_DIR}/../../src modInc)
+  endif()
+
+  if(TEST_SUITE STREQUAL "debounce")
+    listSources(${CMAKE_CURRENT_SOURCE_DIR}/debounce testSrc)
+    listIncludesDir(${CMAKE_CURRENT_SOURCE_DIR}/debounce testInc)
+    listIncludesDir(${CMAKE_CURRENT_SOURCE_DIR}/../../src modInc)
+  endif()
+
+  if(TEST_SUITE STREQUAL "encoderQdec")
+    listSources(${CMAKE_CURRENT_SOURCE_DIR}/encoderQdec testSrc)
+    listIncludesDir(${CMAKE_CURRENT_SOURCE_DIR}/encoderQdec testInc)
+    listIncludesDir(${CMAKE_CURRENT_SOURCE_DIR}/../../src modInc)
+  endif()
+
   # message("testSrc: ${testSrc}")
   # message("testInc: ${testInc}")
   # message("modSrc: ${modSrc}")
@@ -0,0 +1,154 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      test_debounce.c
+ * @author    jbacon
+ * @date      2023-10-17
+ * @brief     Debounce Module Test Cases
+ *
+ *            This file is the test cases of the debounce module.
+ *
+ * @ingroup  debounce
+ *
+ * @{
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "debounce.h"
+#include "debounce.c"
+
+/**
+ * @brief The test sample count.
+*/
+#define TEST_SAMPLE_CNT           3
+
+/**
+ * @brief The test key count.
+*/
+#define TEST_KEY_CNT              8
+
+/**
+ * @brief The test debouncer.
+*/
+static Debouncer debouncer;
+
+ZTEST_SUITE(debounce_suite, NULL, NULL, NULL, NULL, NULL);
+
+#define DEBOUNCE_INIT_FAIL_TEST_CNT   4
+/**
+ * @test  debounceInit must return the error code when the algorithm, the
+ *        key count or the sample count is invalid.
+*/
+ZTEST(debounce_suite, test_debounceInit_InvalidParams)
+{
+  int failRet = -EINVAL;
+  DebounceAlgo algos[DEBOUNCE_INIT_FAIL_TEST_CNT] = {DEBOUNCE_ALGO_COUNT,
+                                                     DEBOUNCE_INTEGRATOR,
+                                                     DEBOUNCE_INTEGRATOR,
+                                                     DEBOUNCE_EAGER};
+  uint8_t keyCounts[DEBOUNCE_INIT_FAIL_TEST_CNT] = {TEST_KEY_CNT, 0,
+                                                    DEBOUNCE_MAX_KEY_CNT + 1,
+                                                    TEST_KEY_CNT};
+  uint8_t samples[DEBOUNCE_INIT_FAIL_TEST_CNT] = {TEST_SAMPLE_CNT,
+                                                  TEST_SAMPLE_CNT,
+                                                  TEST_SAMPLE_CNT, 0};
+
+  for(uint8_t i = 0; i < DEBOUNCE_INIT_FAIL_TEST_CNT; ++i)
+    zassert_equal(failRet, debounceInit(&debouncer, algos[i], keyCounts[i],
+      samples[i]));
+}
+
+/**
+ * @test  debounceInit must initialize the debouncer with all keys released.
+*/
+ZTEST(debounce_suite, test_debounceInit_Success)
+{
+  int successRet = 0;
+
+  debouncer.state = UINT32_MAX;
+  debouncer.counters[0] = 5;
+
+  zassert_equal(successRet, debounceInit(&debouncer, DEBOUNCE_INTEGRATOR,
+    TEST_KEY_CNT, TEST_SAMPLE_CNT));
+  zassert_equal(DEBOUNCE_INTEGRATOR, debouncer.algo);
+  zassert_equal(0xff, debouncer.keyMask);
+  zassert_equal(TEST_SAMPLE_CNT, debouncer.samples);
+  zassert_equal(0, debouncer.state);
+  zassert_equal(0, debouncer.counters[0]);
+
+  zassert_equal(successRet, debounceInit(&debouncer, DEBOUNCE_VERTICAL,
+    DEBOUNCE_MAX_KEY_CNT, TEST_SAMPLE_CNT));
+  zassert_equal(UINT32_MAX, debouncer.keyMask);
+}
+
+/**
+ * @test  debounceUpdate must report the masked raw levels when no debouncing
+ *        is used.
+*/
+ZTEST(debounce_suite, test_debounceUpdate_None)
+{
+  debounceInit(&debouncer, DEBOUNCE_NONE, TEST_KEY_CNT, TEST_SAMPLE_CNT);
+
+  zassert_equal(0xa5, debounceUpdate(&debouncer, 0xa5));
+  zassert_equal(0x5a, debounceUpdate(&debouncer, 0xff5a));
+}
+
+/**
+ * @test  debounceUpdate must change a key state with the integrator
+ *        algorithm only once its level is integrated over the sample count,
+ *        ignoring single sample glitches.
+*/
+ZTEST(debounce_suite, test_debounceUpdate_Integrator)
+{
+  uint32_t samples[] = {0x01, 0x00, 0x01, 0x01, 0x01, 0x00, 0x01, 0x00, 0x00,
+                        0x00};
+  uint32_t expected[] = {0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01, 0x01,
+                         0x00};
+
+  debounceInit(&debouncer, DEBOUNCE_INTEGRATOR, TEST_KEY_CNT,
+    TEST_SAMPLE_CNT);
+
+  for(uint8_t i = 0; i < ARRAY_SIZE(samples); ++i)
+    zassert_equal(expected[i], debounceUpdate(&debouncer, samples[i]),
+      "sample %u", i);
+}
+
+/**
+ * @test  debounceUpdate must report the first edge of a key with the eager
+ *        algorithm and then ignore the key for the lock out sample count.
+*/
+ZTEST(debounce_suite, test_debounceUpdate_Eager)
+{
+  uint32_t samples[] = {0x02, 0x00, 0x02, 0x00, 0x00, 0x00, 0x02};
+  uint32_t expected[] = {0x02, 0x02, 0x02, 0x02, 0x00, 0x00, 0x00};
+
+  debounceInit(&debouncer, DEBOUNCE_EAGER, TEST_KEY_CNT, TEST_SAMPLE_CNT);
+
+  for(uint8_t i = 0; i < ARRAY_SIZE(samples); ++i)
+    zassert_equal(expected[i], debounceUpdate(&debouncer, samples[i]),
+      "sample %u", i);
+}
+
+/**
+ * @test  debounceUpdate must change a key state with the vertical counter
+ *        algorithm after 4 agreeing samples, a disagreeing sample restarting
+ *        the count, and handle all keys at once.
+*/
+ZTEST(debounce_suite, test_debounceUpdate_Vertical)
+{
+  uint32_t samples[] = {0x81, 0x81, 0x80, 0x81, 0x81, 0x81, 0x81, 0x01, 0x01,
+                        0x01, 0x01};
+  uint32_t expected[] = {0x00, 0x00, 0x00, 0x80, 0x80, 0x80, 0x81, 0x81, 0x81,
+                         0x81, 0x01};
+
+  debounceInit(&debouncer, DEBOUNCE_VERTICAL, TEST_KEY_CNT, TEST_SAMPLE_CNT);
+
+  for(uint8_t i = 0; i < ARRAY_SIZE(samples); ++i)
+    zassert_equal(expected[i], debounceUpdate(&debouncer, samples[i]),
+      "sample %u", i);
+}
+
+/** @} */
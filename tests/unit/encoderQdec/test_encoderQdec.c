@@ -0,0 +1,188 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      test_encoderQdec.c
+ * @author    jbacon
+ * @date      2023-10-24
+ * @brief     Encoder QDEC Module Test Cases
+ *
+ *            This file is the test cases of the encoder QDEC module.
+ *
+ * @ingroup  encoderQdec
+ *
+ * @{
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+
+#include "encoderQdec.h"
+#include "encoderQdec.c"
+
+/**
+ * @brief The test counts per revolution.
+*/
+#define TEST_COUNTS_PER_REV       96
+
+/**
+ * @brief The test QDEC counter value.
+*/
+static uint32_t testCounter;
+
+/**
+ * @brief The test sample fetch return value.
+*/
+static int testFetchRet;
+
+/**
+ * @brief The test channel get return value.
+*/
+static int testChannelGetRet;
+
+/**
+ * @brief   The test sample fetch, mimicking the STM32 QDEC driver.
+ */
+static int testSampleFetch(const struct device *dev, enum sensor_channel chan)
+{
+  return testFetchRet;
+}
+
+/**
+ * @brief   The test channel get, reporting the counter as an angle in the
+ *          STM32 QDEC driver Q26.6 format.
+ */
+static int testChannelGet(const struct device *dev, enum sensor_channel chan,
+                          struct sensor_value *val)
+{
+  uint32_t position = testCounter * 23040 / TEST_COUNTS_PER_REV;
+
+  zassert_equal(SENSOR_CHAN_ROTATION, chan);
+
+  val->val1 = position >> 6;
+  val->val2 = (position & 0x3f) * 15625;
+
+  return testChannelGetRet;
+}
+
+/**
+ * @brief The test sensor API.
+*/
+static const struct sensor_driver_api testApi = {
+  .sample_fetch = testSampleFetch,
+  .channel_get = testChannelGet,
+};
+
+/**
+ * @brief The test device state.
+*/
+static struct device_state testState = {
+  .init_res = 0,
+  .initialized = true,
+};
+
+/**
+ * @brief The test QDEC device.
+*/
+static const struct device testDev = {
+  .name = "testQdec",
+  .api = &testApi,
+  .state = &testState,
+};
+
+/**
+ * @brief The test encoder QDEC.
+*/
+static EncoderQdec qdec;
+
+static void encoderQdecCaseSetup(void *f)
+{
+  qdec.dev = &testDev;
+  qdec.countsPerRev = TEST_COUNTS_PER_REV;
+  qdec.lastCount = 0;
+
+  testCounter = 0;
+  testFetchRet = 0;
+  testChannelGetRet = 0;
+  testState.initialized = true;
+}
+
+ZTEST_SUITE(encoderQdec_suite, NULL, NULL, encoderQdecCaseSetup, NULL, NULL);
+
+/**
+ * @test  encoderQdecInit must return the error code when the QDEC is
+ *        invalid, not ready or cannot be read.
+*/
+ZTEST(encoderQdec_suite, test_encoderQdecInit_Fail)
+{
+  qdec.dev = NULL;
+  zassert_equal(-EINVAL, encoderQdecInit(&qdec));
+
+  qdec.dev = &testDev;
+  qdec.countsPerRev = 0;
+  zassert_equal(-EINVAL, encoderQdecInit(&qdec));
+
+  qdec.countsPerRev = TEST_COUNTS_PER_REV;
+  testState.initialized = false;
+  zassert_equal(-ENODEV, encoderQdecInit(&qdec));
+
+  testState.initialized = true;
+  testFetchRet = -EIO;
+  zassert_equal(-EIO, encoderQdecInit(&qdec));
+
+  testFetchRet = 0;
+  testChannelGetRet = -ENOTSUP;
+  zassert_equal(-ENOTSUP, encoderQdecInit(&qdec));
+}
+
+/**
+ * @test  encoderQdecInit must return the success code and record the start
+ *        position.
+*/
+ZTEST(encoderQdec_suite, test_encoderQdecInit_Success)
+{
+  for(testCounter = 0; testCounter < TEST_COUNTS_PER_REV; ++testCounter)
+  {
+    zassert_equal(0, encoderQdecInit(&qdec));
+    zassert_equal(testCounter, qdec.lastCount);
+  }
+}
+
+#define QDEC_DELTA_TEST_CNT       6
+/**
+ * @test  encoderQdecReadDelta must return the counts since the last read,
+ *        handling the counter wrap in both directions.
+*/
+ZTEST(encoderQdec_suite, test_encoderQdecReadDelta_Success)
+{
+  int32_t delta;
+  uint32_t counters[QDEC_DELTA_TEST_CNT] = {0, 5, 95, 3, 3, 60};
+  int32_t expectedDeltas[QDEC_DELTA_TEST_CNT] = {0, 5, -6, 4, 0, -39};
+
+  for(uint8_t i = 0; i < QDEC_DELTA_TEST_CNT; ++i)
+  {
+    testCounter = counters[i];
+    zassert_equal(0, encoderQdecReadDelta(&qdec, &delta));
+    zassert_equal(expectedDeltas[i], delta);
+    zassert_equal(counters[i], qdec.lastCount);
+  }
+}
+
+/**
+ * @test  encoderQdecReadDelta must return the error code and keep the last
+ *        position when the QDEC cannot be read.
+*/
+ZTEST(encoderQdec_suite, test_encoderQdecReadDelta_ReadFail)
+{
+  int32_t delta;
+
+  qdec.lastCount = 7;
+  testCounter = 12;
+  testFetchRet = -EIO;
+
+  zassert_equal(-EIO, encoderQdecReadDelta(&qdec, &delta));
+  zassert_equal(7, qdec.lastCount);
+}
+
+/** @} */
@@ -0,0 +1,164 @@
+/**
+ * Copyright (C) 2023 by Electronya
+ *
+ * @file      test_signalFilter.c
+ * @author    jbacon
+ * @date      2023-11-06
+ * @brief     Signal Filter Module Test Cases
+ *
+ *            This file is the test cases of the signal filter module.
+ *
+ * @ingroup  signalFilter
+ *
+ * @{
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "signalFilter.h"
+#include "signalFilter.c"
+
+/**
+ * @brief The test sample rate [Hz].
+*/
+#define TEST_SAMPLE_RATE_HZ       1000
+
+/**
+ * @brief The test filter.
+*/
+static SignalFilter filter;
+
+/**
+ * @brief The test filter configuration, all the stages disabled.
+*/
+static SignalFilterConfig config;
+
+/**
+ * @brief   Signal filter test cases setup.
+ *
+ * @param f   The test fixture if one exists.
+ */
+static void signalFilterCaseSetup(void *f)
+{
+  config.sampleRateHz = TEST_SAMPLE_RATE_HZ;
+  config.medianSize = 1;
+  config.oversampleBits = 0;
+  config.minCutoffMilliHz = 0;
+  config.betaMicro = 0;
+  config.derivCutoffMilliHz = 0;
+}
+
+ZTEST_SUITE(signalFilter_suite, NULL, NULL, signalFilterCaseSetup, NULL, NULL);
+
+#define FILTER_INIT_FAIL_TEST_CNT     7
+/**
+ * @test  signalFilterInit must return the error code when the configuration
+ *        is invalid.
+*/
+ZTEST(signalFilter_suite, test_signalFilterInit_InvalidConfig)
+{
+  int failRet = -EINVAL;
+  uint32_t rates[FILTER_INIT_FAIL_TEST_CNT] = {0, TEST_SAMPLE_RATE_HZ,
+                                               TEST_SAMPLE_RATE_HZ,
+                                               TEST_SAMPLE_RATE_HZ,
+                                               TEST_SAMPLE_RATE_HZ,
+                                               TEST_SAMPLE_RATE_HZ, 15};
+  uint8_t medianSizes[FILTER_INIT_FAIL_TEST_CNT] = {1, 0, 4,
+                                                    SIGNAL_FILTER_MEDIAN_MAX + 2,
+                                                    1, 1, 1};
+  uint8_t oversampleBits[FILTER_INIT_FAIL_TEST_CNT] = {0, 0, 0, 0,
+                                                       SIGNAL_FILTER_OVERSAMPLE_MAX + 1,
+                                                       0, 2};
+  uint32_t derivCutoffs[FILTER_INIT_FAIL_TEST_CNT] = {1000, 1000, 1000, 1000,
+                                                      1000, 0, 1000};
+
+  config.minCutoffMilliHz = 1000;
+  for(uint8_t i = 0; i < FILTER_INIT_FAIL_TEST_CNT; ++i)
+  {
+    config.sampleRateHz = rates[i];
+    config.medianSize = medianSizes[i];
+    config.oversampleBits = oversampleBits[i];
+    config.derivCutoffMilliHz = derivCutoffs[i];
+
+    zassert_equal(failRet, signalFilterInit(&filter, &config));
+  }
+}
+
+/**
+ * @test  signalFilterUpdate must pass the samples through when all the stages
+ *        are disabled.
+*/
+ZTEST(signalFilter_suite, test_signalFilterUpdate_PassThrough)
+{
+  uint32_t samples[] = {0, 4095, 12, 2048};
+
+  zassert_equal(0, signalFilterInit(&filter, &config));
+
+  for(uint8_t i = 0; i < ARRAY_SIZE(samples); ++i)
+    zassert_equal(samples[i], signalFilterUpdate(&filter, samples[i]));
+}
+
+/**
+ * @test  signalFilterUpdate must reject the single sample spikes with the
+ *        median stage.
+*/
+ZTEST(signalFilter_suite, test_signalFilterUpdate_MedianRejectSpike)
+{
+  uint32_t samples[] = {1000, 1002, 4095, 1001, 0, 1003, 1004};
+  uint32_t expected[] = {1000, 1002, 1002, 1002, 1001, 1001, 1003};
+
+  config.medianSize = 3;
+  zassert_equal(0, signalFilterInit(&filter, &config));
+
+  for(uint8_t i = 0; i < ARRAY_SIZE(samples); ++i)
+    zassert_equal(expected[i], signalFilterUpdate(&filter, samples[i]));
+}
+
+/**
+ * @test  signalFilterUpdate must only update the output once every 4^n
+ *        samples with the n extra bits of the oversampling stage.
+*/
+ZTEST(signalFilter_suite, test_signalFilterUpdate_Oversample)
+{
+  uint32_t samples[] = {100, 101, 101, 101, 200, 200, 200, 200};
+  uint32_t expected[] = {200, 200, 200, 201, 201, 201, 201, 400};
+
+  config.oversampleBits = 1;
+  zassert_equal(0, signalFilterInit(&filter, &config));
+
+  for(uint8_t i = 0; i < ARRAY_SIZE(samples); ++i)
+    zassert_equal(expected[i], signalFilterUpdate(&filter, samples[i]));
+}
+
+/**
+ * @test  signalFilterUpdate must smooth the jitter at rest and follow a fast
+ *        move with the One-Euro stage.
+*/
+ZTEST(signalFilter_suite, test_signalFilterUpdate_OneEuro)
+{
+  uint32_t output;
+
+  config.minCutoffMilliHz = 1000;
+  config.betaMicro = 10000;
+  config.derivCutoffMilliHz = 1000;
+  zassert_equal(0, signalFilterInit(&filter, &config));
+
+  /* the first sample primes the filter */
+  zassert_equal(2000, signalFilterUpdate(&filter, 2000));
+
+  /* jitter at rest */
+  for(uint8_t i = 0; i < 100; ++i)
+  {
+    output = signalFilterUpdate(&filter, i & 1 ? 2010 : 1990);
+    zassert_within(output, 2000, 2);
+  }
+
+  /* fast drop */
+  for(uint8_t i = 0; i < 50; ++i)
+    output = signalFilterUpdate(&filter, 0);
+  zassert_true(output < 100);
+}
+
+/** @} */